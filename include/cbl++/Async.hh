@@ -0,0 +1,122 @@
+//
+// Async.hh
+//
+// Copyright (c) 2024 Couchbase, Inc All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "cbl++/Base.hh"
+
+// The awaitable API requires C++20 coroutines; without them this header declares nothing.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define CBL_CPP_COROUTINES 1
+
+#include <coroutine>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+// VOLATILE API: Couchbase Lite C++ API is not finalized, and may change in
+// future releases.
+
+CBL_ASSUME_NONNULL_BEGIN
+
+namespace cbl {
+
+    /** A function that runs a job asynchronously, typically on a thread pool.
+        The awaitable methods, such as \ref Collection::getDocumentAsync, run their blocking work
+        on an Executor, and resume the awaiting coroutine on the Executor's thread. */
+    using Executor = std::function<void(std::function<void()> job)>;
+
+    namespace internal {
+        struct DefaultExecutor {
+            static std::mutex& mutex()             {static std::mutex m; return m;}
+            static Executor& executor()            {static Executor e; return e;}
+        };
+    }
+
+    /** Sets the Executor used by awaitable methods that aren't given one explicitly.
+        Passing an empty Executor restores the default, which runs each job on a new thread. */
+    inline void setDefaultExecutor(Executor executor) {
+        std::lock_guard<std::mutex> lock(internal::DefaultExecutor::mutex());
+        internal::DefaultExecutor::executor() = std::move(executor);
+    }
+
+    /** Returns \p executor if it's non-empty, else the default Executor. */
+    inline Executor executorOrDefault(const Executor &executor) {
+        if (executor)
+            return executor;
+        {
+            std::lock_guard<std::mutex> lock(internal::DefaultExecutor::mutex());
+            if (internal::DefaultExecutor::executor())
+                return internal::DefaultExecutor::executor();
+        }
+        return [](std::function<void()> job) {
+            std::thread(std::move(job)).detach();
+        };
+    }
+
+
+    /** An awaitable that, when awaited, runs a function on an Executor and then resumes the
+        awaiting coroutine with the function's result, or rethrows its exception.
+        Nothing happens until the object is `co_await`ed. */
+    template <class T>
+    class [[nodiscard]] AsyncResult {
+    public:
+        AsyncResult(std::function<T()> fn, Executor executor)
+        :_fn(std::move(fn))
+        ,_executor(executorOrDefault(executor))
+        { }
+
+        AsyncResult(AsyncResult&&) = default;
+        AsyncResult(const AsyncResult&) = delete;
+        AsyncResult& operator=(const AsyncResult&) = delete;
+
+        bool await_ready() const noexcept              {return false;}
+
+        void await_suspend(std::coroutine_handle<> awaiter) {
+            // The job may resume the coroutine, destroying this awaitable, before the executor
+            // returns; so call a copy of the executor, which outlives the call:
+            auto executor = _executor;
+            executor([this, awaiter] {
+                try {
+                    _result.emplace(_fn());
+                } catch (...) {
+                    _exception = std::current_exception();
+                }
+                awaiter.resume();
+            });
+        }
+
+        T await_resume() {
+            if (_exception)
+                std::rethrow_exception(_exception);
+            return std::move(*_result);
+        }
+
+    private:
+        std::function<T()>          _fn;
+        Executor                    _executor;
+        std::optional<T>            _result;
+        std::exception_ptr          _exception;
+    };
+
+}
+
+CBL_ASSUME_NONNULL_END
+
+#endif // __cpp_impl_coroutine
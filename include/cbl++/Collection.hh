@@ -17,12 +17,15 @@
 //
 
 #pragma once
+#include "cbl++/Async.hh"
 #include "cbl++/Base.hh"
 #include "cbl++/Database.hh"
 #include "cbl/CBLCollection.h"
 #include "cbl/CBLScope.h"
 #include "fleece/Mutable.hh"
+#include <exception>
 #include <functional>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -36,13 +39,22 @@ namespace cbl {
     class MutableDocument;
     class CollectionChange;
     class DocumentChange;
+    class DocumentEnumerator;
+    class ChangeBatch;
     class QueryIndex;
     class VectorIndexConfiguration;
+#ifdef CBL_CPP_COROUTINES
+    class AsyncSave;
+#endif
 
     /** Conflict handler used when saving a document. */
     using CollectionConflictHandler = std::function<bool(MutableDocument documentBeingSaved,
                                                          Document conflictingDocument)>;
 
+    /** Callback invoked when a save queued by \ref Collection::saveDocumentAsync has finished.
+        If the document wasn't saved, the error tells why. */
+    using SaveCompletion = std::function<void(MutableDocument document, bool saved, CBLError error)>;
+
     /**
      A Collection class represent a collection which is a container for documents.
      A collection can be thought as a table in the relational database. Each collection belongs to
@@ -83,6 +95,9 @@ namespace cbl {
         
         /** The number of documents in the collection. */
         uint64_t count() const                          {return CBLCollection_Count(ref());}
+
+        /** The collection's last sequence known to have been synced to disk. */
+        uint64_t lastDurableSequence() const            {return CBLCollection_LastDurableSequence(ref());}
         
         // Documents:
         
@@ -92,6 +107,43 @@ namespace cbl {
             @return A new \ref Document instance, or NULL if the doc doesn't exist, or throws if an error occurred. */
         inline Document getDocument(slice docID) const;
         
+        /** Reads multiple documents from the collection in an immutable form, locking the
+            collection only once for the whole batch.
+            @param docIDs  An array of document ID strings.
+            @return A vector with one \ref Document per docID, which is NULL if the doc doesn't exist,
+                    or throws if an error occurred. */
+        inline std::vector<Document> getDocuments(fleece::Array docIDs) const;
+        
+        /** Reads a document's current revision without creating a \ref Document, by calling
+            \p callback with the revision's properties and metadata.
+            @warning The \ref CBLDocumentRevisionInfo is only valid until the callback returns.
+            @param docID  The ID of the document.
+            @param callback  A callable taking a `const CBLDocumentRevisionInfo&`. If it throws, the
+                    exception is rethrown by this method.
+            @return True if the document exists and the callback was called, false if the document
+                    doesn't exist, or throws if an error occurred. */
+        template <class Callback>
+        bool readDocument(slice docID, Callback callback) const {
+            struct Context {
+                Callback&           callback;
+                std::exception_ptr  exception;
+            } context {callback, nullptr};
+            CBLError error;
+            bool found = CBLCollection_ReadDocument(ref(), docID, [](void* ctx, const CBLDocumentRevisionInfo* info) {
+                auto context = (Context*)ctx;
+                try {
+                    context->callback(*info);
+                } catch (...) {
+                    context->exception = std::current_exception();
+                }
+            }, &context, &error);
+            if (context.exception)
+                std::rethrow_exception(context.exception);
+            if (!found && error.code != 0)
+                throw error;
+            return found;
+        }
+        
         /** Reads a document from the collection in mutable form that can be updated and saved.
             (This function is otherwise identical to \ref Collection::getDocument(slice docID).)
             @param docID  The ID of the document.
@@ -125,6 +177,73 @@ namespace cbl {
         _cbl_warn_unused
         inline bool saveDocument(MutableDocument &doc, CollectionConflictHandler handler);
 
+        /** Queues a (mutable) document to be saved asynchronously by the database's writer thread,
+            which commits saves queued by many threads in a single transaction.
+            @warning  The document must not be modified until the completion has been called.
+            @param doc  The mutable document to save.
+            @param concurrency  Conflict-handling strategy (fail or overwrite).
+            @param completion  The callback to be invoked after the save has been committed. */
+        inline void saveDocumentAsync(MutableDocument &doc,
+                                      CBLConcurrencyControl concurrency,
+                                      SaveCompletion completion);
+
+        /** Saves multiple (mutable) documents to the collection in a single transaction.
+            If a conflicting revision of a document has been saved since it was loaded, the
+            \p concurrency parameter specifies whether that document should be skipped, or the
+            conflicting revision should be overwritten with the revision being saved.
+            @param docs  The mutable documents to save.
+            @param concurrency  Conflict-handling strategy (fail or overwrite).
+            @return A vector with one entry per document; true if it was saved, false if it was
+                    not saved due to a conflict. */
+        inline std::vector<bool> saveDocuments(std::vector<MutableDocument> &docs,
+                                               CBLConcurrencyControl concurrency =kCBLConcurrencyControlLastWriteWins);
+
+#ifdef CBL_CPP_COROUTINES
+        /** Awaitable version of \ref Collection::getDocument(slice docID). The document is read on
+            \p executor (or the default \ref Executor), which then resumes the awaiting coroutine.
+            @param docID  The ID of the document.
+            @param executor  The executor to read on; if empty, the default executor is used.
+            @return An awaitable whose result is the \ref Document, or NULL if it doesn't exist. */
+        inline AsyncResult<Document> getDocumentAsync(slice docID, Executor executor ={}) const;
+
+        /** Awaitable version of \ref Collection::getMutableDocument(slice docID).
+            @param docID  The ID of the document.
+            @param executor  The executor to read on; if empty, the default executor is used.
+            @return An awaitable whose result is the \ref MutableDocument, or NULL if it doesn't exist. */
+        inline AsyncResult<MutableDocument> getMutableDocumentAsync(slice docID, Executor executor ={}) const;
+
+        /** Awaitable save. The document is queued on the database's write queue, like
+            \ref Collection::saveDocumentAsync, so awaiting doesn't block any thread; once the save
+            has been committed the awaiting coroutine is resumed on \p executor.
+            @warning  The document must not be modified until the save has completed.
+            @param doc  The mutable document to save.
+            @param concurrency  Conflict-handling strategy (fail or overwrite).
+            @param executor  The executor to resume on; if empty, the default executor is used.
+            @return An awaitable whose result is true if the document was saved, false if there
+                    was a conflict; other errors are thrown. */
+        inline AsyncSave saveAsync(MutableDocument &doc,
+                                   CBLConcurrencyControl concurrency =kCBLConcurrencyControlLastWriteWins,
+                                   Executor executor ={});
+#endif
+        
+        /** Updates a document by applying a JSON Merge Patch to its current revision, in a single
+            transaction. If the document doesn't exist or is deleted, it's created.
+            @param docID  The ID of the document.
+            @param patch  The merge patch to apply. */
+        void patchDocument(slice docID, fleece::Dict patch) {
+            CBLError error;
+            check(CBLCollection_PatchDocument(ref(), docID, patch, &error), error);
+        }
+        
+        /** Updates a document by applying a JSON Merge Patch, given as JSON, to its current revision.
+            (This function is otherwise identical to \ref Collection::patchDocument(slice docID, fleece::Dict patch).)
+            @param docID  The ID of the document.
+            @param jsonPatch  The merge patch to apply, as JSON. */
+        void patchDocumentWithJSON(slice docID, slice jsonPatch) {
+            CBLError error;
+            check(CBLCollection_PatchDocumentWithJSON(ref(), docID, jsonPatch, &error), error);
+        }
+
         /** Deletes a document from the collection. Deletions are replicated.
             @param doc  The document to delete. */
         inline void deleteDocument(Document &doc);
@@ -154,6 +273,28 @@ namespace cbl {
             return purged;
         }
         
+        /** Deletes multiple documents by ID in a single transaction.
+            @param docIDs  An array of document ID strings.
+            @return  A vector with one entry per document ID: true if the document was deleted,
+                     false if it doesn't exist or is already deleted. */
+        std::vector<bool> deleteDocuments(fleece::Array docIDs) {
+            auto results = std::make_unique<bool[]>(docIDs.count());
+            CBLError error;
+            check(CBLCollection_DeleteDocuments(ref(), docIDs, results.get(), &error), error);
+            return std::vector<bool>(results.get(), results.get() + docIDs.count());
+        }
+        
+        /** Purges multiple documents by ID in a single transaction.
+            @param docIDs  An array of document ID strings.
+            @return  A vector with one entry per document ID: true if the document was purged,
+                     false if it doesn't exist. */
+        std::vector<bool> purgeDocuments(fleece::Array docIDs) {
+            auto results = std::make_unique<bool[]>(docIDs.count());
+            CBLError error;
+            check(CBLCollection_PurgeDocuments(ref(), docIDs, results.get(), &error), error);
+            return std::vector<bool>(results.get(), results.get() + docIDs.count());
+        }
+        
         /** Returns the time, if any, at which a given document in the collection will expire and be purged.
             Documents don't normally expire; you have to call \ref Collection::setDocumentExpiration(slice docID, time_t expiration)
             to set a document's expiration time.
@@ -176,6 +317,38 @@ namespace cbl {
             check(CBLCollection_SetDocumentExpiration(ref(), docID, expiration, &error), error);
         }
         
+        // Bulk Import:
+        
+        /** Imports documents from a JSON Lines file, where each line is a JSON object that
+            becomes the body of one document.
+            @param path  The path of the JSON Lines file.
+            @param options  The import options, or NULL for the default options.
+            @return  The number of imported documents. */
+        uint64_t importJSONLines(slice path,
+                                 const CBLImportJSONLinesOptions* _cbl_nullable options =nullptr)
+        {
+            CBLError error;
+            uint64_t count = 0;
+            check(CBLCollection_ImportJSONLinesFile(ref(), path, options, &count, &error), error);
+            return count;
+        }
+        
+        // Enumeration:
+        
+        /** Creates an enumerator over the documents in the collection.
+            @param options  The enumeration options, or NULL for the default options.
+            @return  A new enumerator, positioned before the first document. */
+        inline DocumentEnumerator enumerateDocuments(const CBLDocumentEnumeratorOptions* _cbl_nullable options =nullptr) const;
+        
+        /** Reads the documents that have changed since a given sequence, in sequence order.
+            @param sinceSequence  Only documents whose sequence is greater than this are returned.
+            @param limit  The maximum number of changes to return, or 0 for no limit.
+            @param flags  Flags for the changes to return.
+            @return  A batch of changes, which is empty if there are no more changes. */
+        inline ChangeBatch getChangesSince(uint64_t sinceSequence,
+                                           unsigned limit =0,
+                                           CBLChangesFlags flags =0) const;
+        
         // Indexes:
 
         /** Creates a value index in the collection.
@@ -337,6 +510,59 @@ namespace cbl {
         slice _docID;
     };
 
+    /** An iterator over the documents in a collection. */
+    class DocumentEnumerator : private RefCounted {
+    public:
+        /** Moves to the next document. Returns false at the end, or throws if an error occurred. */
+        bool next() {
+            CBLError error;
+            bool hasNext = CBLDocumentEnumerator_Next(ref(), &error);
+            if (!hasNext && error.code != 0)
+                throw error;
+            return hasNext;
+        }
+        
+        /** The current document's ID. */
+        slice docID() const                         {return CBLDocumentEnumerator_DocumentID(ref());}
+        
+        /** The current document's revision ID. */
+        slice revisionID() const                    {return CBLDocumentEnumerator_RevisionID(ref());}
+        
+        /** The current document's sequence in the local database. */
+        uint64_t sequence() const                   {return CBLDocumentEnumerator_Sequence(ref());}
+        
+        /** True if the current document is deleted. */
+        bool isDeleted() const                      {return CBLDocumentEnumerator_IsDeleted(ref());}
+        
+        /** The current document's properties, or NULL if the enumerator only reads metadata.
+            @warning  The properties are only valid until the enumerator is advanced. */
+        fleece::Dict properties() const             {return CBLDocumentEnumerator_Properties(ref());}
+        
+        /** Returns the current document as a new \ref Document. */
+        inline Document getDocument() const;
+        
+    private:
+        friend class Collection;
+        CBL_REFCOUNTED_BOILERPLATE(DocumentEnumerator, RefCounted, CBLDocumentEnumerator)
+    };
+
+    /** A batch of document changes read from a collection. */
+    class ChangeBatch : private RefCounted {
+    public:
+        /** The number of changes in the batch. */
+        size_t count() const                        {return CBLChangeBatch_Count(ref());}
+        
+        /** The change at the given index. */
+        const CBLChangedDocument& operator[] (size_t index) const {return *CBLChangeBatch_Get(ref(), index);}
+        
+        /** The sequence to pass to \ref Collection::getChangesSince to read the following changes. */
+        uint64_t lastSequence() const               {return CBLChangeBatch_LastSequence(ref());}
+        
+    private:
+        friend class Collection;
+        CBL_REFCOUNTED_BOILERPLATE(ChangeBatch, RefCounted, CBLChangeBatch)
+    };
+
     // Database method bodies:
 
     inline Collection Database::getCollection(slice collectionName, slice scopeName) const {
@@ -356,6 +582,27 @@ namespace cbl {
 
     // Collection method bodies:
 
+    inline DocumentEnumerator Collection::enumerateDocuments(const CBLDocumentEnumeratorOptions* _cbl_nullable options) const {
+        CBLError error;
+        auto e = CBLCollection_EnumerateDocuments(ref(), options, &error);
+        check(e, error);
+        DocumentEnumerator result;
+        result._ref = (CBLRefCounted*)e;
+        return result;
+    }
+
+    inline ChangeBatch Collection::getChangesSince(uint64_t sinceSequence,
+                                                   unsigned limit,
+                                                   CBLChangesFlags flags) const
+    {
+        CBLError error;
+        auto b = CBLCollection_GetChangesSince(ref(), sinceSequence, limit, flags, &error);
+        check(b, error);
+        ChangeBatch result;
+        result._ref = (CBLRefCounted*)b;
+        return result;
+    }
+
     inline void Collection::_callListener(void* _cbl_nullable context, const CBLCollectionChange* change) {
         Collection col = Collection((CBLCollection*)change->collection);
         std::vector<slice> docIDs((slice*)&change->docIDs[0], (slice*)&change->docIDs[change->numDocs]);
@@ -20,6 +20,7 @@
 // future releases.
 
 #pragma once
+#include "Async.hh"
 #include "Blob.hh"
 #include "Collection.hh"
 #include "Database.hh"
@@ -159,6 +159,53 @@ namespace cbl {
             check(CBLDatabase_PerformMaintenance(ref(), type, &error), error);
         }
 
+        /** Sets the number of read-only connections used for concurrent reads; zero disables them.
+            See \ref CBLDatabase_SetReaderPoolSize. */
+        void setReaderPoolSize(unsigned size) {
+            CBLError error;
+            check(CBLDatabase_SetReaderPoolSize(ref(), size, &error), error);
+        }
+
+        /** The number of read-only connections used for concurrent reads. */
+        unsigned readerPoolSize() const                 {return CBLDatabase_ReaderPoolSize(ref());}
+
+        /** Sets the maximum number of compiled queries to cache; zero disables the cache.
+            See \ref CBLDatabase_SetQueryCacheCapacity. */
+        void setQueryCacheCapacity(size_t capacity) {
+            CBLError error;
+            check(CBLDatabase_SetQueryCacheCapacity(ref(), capacity, &error), error);
+        }
+
+        /** Returns the compiled query cache statistics. */
+        CBLQueryCacheStats queryCacheStats() const      {return CBLDatabase_GetQueryCacheStats(ref());}
+
+        /** Sets the longest time between committing a transaction with \ref kCBLDurabilityDeferred
+            and syncing it to disk. */
+        void setDeferredDurabilityInterval(unsigned intervalMS) {
+            CBLDatabase_SetDeferredDurabilityInterval(ref(), intervalMS);
+        }
+
+        /** Enables or disables the recording of lock contention statistics. */
+        void setLockStatsEnabled(bool enabled)          {CBLDatabase_SetLockStatsEnabled(ref(), enabled);}
+
+        /** Returns the lock contention statistics. */
+        CBLLockStats lockStats() const                  {return CBLDatabase_GetLockStats(ref());}
+
+        /** Resets the lock contention statistics to zero. */
+        void resetLockStats()                           {CBLDatabase_ResetLockStats(ref());}
+
+        /** Sets the options of the write queue used by \ref Collection::saveDocumentAsync. */
+        void setWriteQueueOptions(const CBLWriteQueueOptions &options) {
+            CBLError error;
+            check(CBLDatabase_SetWriteQueueOptions(ref(), &options, &error), error);
+        }
+
+        /** Blocks until all saves queued by \ref Collection::saveDocumentAsync have been committed. */
+        void flushWriteQueue() {
+            CBLError error;
+            check(CBLDatabase_FlushWriteQueue(ref(), &error), error);
+        }
+
         // Accessors:
         
         /** Returns the database's name. */
@@ -355,8 +402,9 @@ namespace cbl {
             _db = db;
         }
 
-        /** Commits changes and ends the transaction. */
-        void commit()   {end(true);}
+        /** Commits changes and ends the transaction.
+            @param durability  How soon to sync the changes to disk. */
+        void commit(CBLDurability durability =kCBLDurabilityNone)   {end(true, durability);}
 
         /** Ends the transaction, rolling back changes. */
         void abort()    {end(false);}
@@ -364,12 +412,12 @@ namespace cbl {
         ~Transaction()  {end(false);}
 
     private:
-        void end(bool commit) {
+        void end(bool commit, CBLDurability durability =kCBLDurabilityNone) {
             CBLDatabase *db = _db;
             if (db) {
                 _db = nullptr;
                 CBLError error;
-                if (!CBLDatabase_EndTransaction(db, commit, &error)) {
+                if (!CBLDatabase_EndTransactionWithDurability(db, commit, durability, &error)) {
                     // If an exception is thrown while a Batch is in scope, its destructor will
                     // call end(). If I'm in this situation I cannot throw another exception or
                     // the C++ runtime will abort the process. Detect this and just warn instead.
@@ -22,6 +22,7 @@
 #include "cbl/CBLDocument.h"
 #include "fleece/Mutable.hh"
 #include <string>
+#include <vector>
 
 // VOLATILE API: Couchbase Lite C++ API is not finalized, and may change in
 // future releases.
@@ -74,8 +75,10 @@ namespace cbl {
         inline MutableDocument mutableCopy() const;
 
     protected:
+        friend class AsyncSave;
         friend class Collection;
         friend class Database;
+        friend class DocumentEnumerator;
         friend class Replicator;
         
         Document(CBLRefCounted* r)                  :RefCounted(r) { }
@@ -190,6 +193,25 @@ namespace cbl {
         return Document::adopt(CBLCollection_GetDocument(ref(), id, &error), &error);
     }
 
+    inline std::vector<Document> Collection::getDocuments(fleece::Array docIDs) const {
+        std::vector<const CBLDocument*> cDocs(docIDs.count());
+        CBLError error;
+        check(CBLCollection_GetDocuments(ref(), docIDs, cDocs.data(), &error), error);
+        std::vector<Document> docs;
+        docs.reserve(cDocs.size());
+        for (auto cDoc : cDocs) {
+            Document doc;
+            doc._ref = (CBLRefCounted*)cDoc;
+            docs.push_back(std::move(doc));
+        }
+        return docs;
+    }
+
+    inline Document DocumentEnumerator::getDocument() const {
+        CBLError error;
+        return Document::adopt(CBLDocumentEnumerator_GetDocument(ref(), &error), &error);
+    }
+
     inline MutableDocument Collection::getMutableDocument(slice id) const {
         CBLError error;
         return MutableDocument::adopt(CBLCollection_GetMutableDocument(ref(), id, &error), &error);
@@ -217,6 +239,36 @@ namespace cbl {
                                                           &conflictHandler, &error), error);
     }
 
+    inline void Collection::saveDocumentAsync(MutableDocument &doc,
+                                              CBLConcurrencyControl concurrency,
+                                              SaveCompletion completion)
+    {
+        CBLSaveCompletionCallback cCompletion = [](void *context, CBLDocument *cDoc,
+                                                   bool saved, CBLError error) {
+            std::unique_ptr<SaveCompletion> completion((SaveCompletion*)context);
+            (*completion)(MutableDocument(cDoc), saved, error);
+        };
+        auto context = new SaveCompletion(std::move(completion));
+        CBLError error;
+        if (!CBLCollection_SaveDocumentAsync(ref(), doc.ref(), concurrency, cCompletion, context, &error)) {
+            delete context;
+            throw error;
+        }
+    }
+
+    inline std::vector<bool> Collection::saveDocuments(std::vector<MutableDocument> &docs,
+                                                       CBLConcurrencyControl c)
+    {
+        std::vector<CBLDocument*> cDocs;
+        cDocs.reserve(docs.size());
+        for (auto &doc : docs)
+            cDocs.push_back(doc.ref());
+        auto results = std::make_unique<bool[]>(docs.size());
+        CBLError error;
+        check(CBLCollection_SaveDocuments(ref(), cDocs.data(), cDocs.size(), c, results.get(), &error), error);
+        return std::vector<bool>(results.get(), results.get() + docs.size());
+    }
+
     inline void Collection::deleteDocument(Document &doc) {
         (void) deleteDocument(doc, kCBLConcurrencyControlLastWriteWins);
     }
@@ -231,6 +283,70 @@ namespace cbl {
         CBLError error;
         check(CBLCollection_PurgeDocument(ref(), doc.ref(), &error), error);
     }
+
+#ifdef CBL_CPP_COROUTINES
+
+    /** Awaitable returned by \ref Collection::saveAsync. */
+    class [[nodiscard]] AsyncSave {
+    public:
+        AsyncSave(Collection collection, MutableDocument doc,
+                  CBLConcurrencyControl concurrency, Executor executor)
+        :_collection(std::move(collection))
+        ,_doc(std::move(doc))
+        ,_concurrency(concurrency)
+        ,_executor(executorOrDefault(executor))
+        { }
+
+        AsyncSave(AsyncSave&&) = default;
+        AsyncSave(const AsyncSave&) = delete;
+        AsyncSave& operator=(const AsyncSave&) = delete;
+
+        bool await_ready() const noexcept              {return false;}
+
+        void await_suspend(std::coroutine_handle<> awaiter) {
+            // Resuming the coroutine may destroy this awaitable while the executor is still
+            // running, so the completion calls its own copy of the executor:
+            _collection.saveDocumentAsync(_doc, _concurrency,
+                                          [this, awaiter, executor = _executor](MutableDocument, bool saved,
+                                                                                CBLError error) {
+                _saved = saved;
+                _error = error;
+                executor([awaiter] { awaiter.resume(); });
+            });
+        }
+
+        bool await_resume() {
+            return Document::checkSave(_saved, _error);
+        }
+
+    private:
+        Collection                  _collection;
+        MutableDocument             _doc;
+        CBLConcurrencyControl       _concurrency;
+        Executor                    _executor;
+        bool                        _saved {false};
+        CBLError                    _error {};
+    };
+
+    inline AsyncResult<Document> Collection::getDocumentAsync(slice docID, Executor executor) const {
+        return AsyncResult<Document>([collection = *this, id = alloc_slice(docID)] {
+            return collection.getDocument(id);
+        }, std::move(executor));
+    }
+
+    inline AsyncResult<MutableDocument> Collection::getMutableDocumentAsync(slice docID, Executor executor) const {
+        return AsyncResult<MutableDocument>([collection = *this, id = alloc_slice(docID)] {
+            return collection.getMutableDocument(id);
+        }, std::move(executor));
+    }
+
+    inline AsyncSave Collection::saveAsync(MutableDocument &doc, CBLConcurrencyControl concurrency,
+                                           Executor executor)
+    {
+        return AsyncSave(*this, doc, concurrency, std::move(executor));
+    }
+
+#endif // CBL_CPP_COROUTINES
 }
 
 CBL_ASSUME_NONNULL_END
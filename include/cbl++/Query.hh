@@ -17,6 +17,7 @@
 //
 
 #pragma once
+#include "cbl++/Async.hh"
 #include "cbl++/Database.hh"
 #include "cbl/CBLQuery.h"
 #include <stdexcept>
@@ -63,6 +64,12 @@ namespace cbl {
             Every column is guaranteed to have a unique name. */
         inline std::vector<std::string> columnNames() const;
 
+        /** Returns the index of the column with the given name, or -1 if there's none.
+            Use it with \ref Result::valueAtIndex to avoid looking up the name in every result. */
+        int columnIndex(slice name) const {
+            return CBLQuery_ColumnIndex(ref(), name);
+        }
+
         /** Assigns values to the query's parameters.
             These values will be substited for those parameters whenever the query is executed,
             until they are next assigned.
@@ -80,6 +87,14 @@ namespace cbl {
         /** Runs the query, returning the results. */
         inline ResultSet execute();
 
+#ifdef CBL_CPP_COROUTINES
+        /** Awaitable version of \ref Query::execute. The query runs on \p executor (or the default
+            \ref Executor), which then resumes the awaiting coroutine.
+            @param executor  The executor to run on; if empty, the default executor is used.
+            @return An awaitable whose result is the \ref ResultSet. */
+        inline AsyncResult<ResultSet> executeAsync(Executor executor ={});
+#endif
+
         /** Returns information about the query, including the translated SQLite form, and the search
             strategy. You can use this to help optimize the query: the word `SCAN` in the strategy
             indicates a linear scan of the entire database, which should be avoided by adding an index.
@@ -100,7 +115,8 @@ namespace cbl {
             the listener(s) of the results when ready. After that, it will run in the background after
             the database changes, and only notify the listeners when the result set changes.
             @param callback  The callback to be invoked.
-            @return A Change Listener Token. Call \ref ListenerToken::remove() method to remove the listener. */
+            @return A Change Listener Token. Call \ref ListenerToken::remove() method to remove the listener.
+                    Throws \ref kCBLErrorUnsupported if the query belongs to a single-threaded database. */
         [[nodiscard]] inline ChangeListener addChangeListener(ListenerToken<Change>::Callback callback);
 
     private:
@@ -216,6 +232,14 @@ namespace cbl {
         return ResultSet::adopt(rs);
     }
 
+#ifdef CBL_CPP_COROUTINES
+    inline AsyncResult<ResultSet> Query::executeAsync(Executor executor) {
+        return AsyncResult<ResultSet>([query = *this]() mutable {
+            return query.execute();
+        }, std::move(executor));
+    }
+#endif
+
     class Query::ChangeListener : public ListenerToken<Change> {
     public:
         ChangeListener(): ListenerToken<Change>() { }
@@ -267,7 +291,11 @@ namespace cbl {
 
     inline Query::ChangeListener Query::addChangeListener(ChangeListener::Callback f) {
         auto l = ChangeListener(*this, f);
-        l.setToken( CBLQuery_AddChangeListener(ref(), &_callListener, l.context()) );
+        auto token = CBLQuery_AddChangeListener(ref(), &_callListener, l.context());
+        // Only fails if the query belongs to a single-threaded database:
+        CBLError error = {kCBLDomain, kCBLErrorUnsupported, 0};
+        check(token != nullptr, error);
+        l.setToken(token);
         return l;
     }
 
@@ -193,6 +193,12 @@ typedef struct CBLScope CBLScope;
      @{ */
 /** A collection, a document container. */
 typedef struct CBLCollection    CBLCollection;
+
+/** An iterator over the documents in a collection. */
+typedef struct CBLDocumentEnumerator CBLDocumentEnumerator;
+
+/** A batch of document changes read from a collection. */
+typedef struct CBLChangeBatch CBLChangeBatch;
 /** @} */
 
 /** \defgroup documents  Documents
@@ -217,6 +223,9 @@ typedef struct CBLQuery      CBLQuery;
 
 /** An iterator over the rows resulting from running a query. */
 typedef struct CBLResultSet  CBLResultSet;
+
+/** An asynchronous execution of a query, which can be canceled. */
+typedef struct CBLQueryTask  CBLQueryTask;
 /** @} */
 
 /** \defgroup index  Index
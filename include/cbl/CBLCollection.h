@@ -186,6 +186,14 @@ CBLDatabase* CBLCollection_Database(const CBLCollection* collection) CBLAPI;
     @return  the number of documents in the collection. */
 uint64_t CBLCollection_Count(const CBLCollection* collection) CBLAPI;
 
+/** Returns the collection's last sequence known to have been synced to disk by a transaction
+    committed with \ref kCBLDurabilityImmediate or \ref kCBLDurabilityDeferred. Changes up to this
+    sequence survive an OS crash or power failure. If the database was opened with
+    \ref CBLDatabaseConfiguration.fullSync, every commit is synced, so this is the last sequence.
+    @param collection  The collection.
+    @return  The last durable sequence, or 0 if none is known. */
+uint64_t CBLCollection_LastDurableSequence(const CBLCollection* collection) CBLAPI;
+
 /** @} */
 
 /** \name  Document lifecycle
@@ -205,6 +213,65 @@ const CBLDocument* _cbl_nullable CBLCollection_GetDocument(const CBLCollection*
                                                            FLString docID,
                                                            CBLError* _cbl_nullable outError) CBLAPI;
 
+/** Reads multiple documents from the collection, creating a new (immutable) \ref CBLDocument
+    object for each one that exists.
+    This is equivalent to calling \ref CBLCollection_GetDocument once per ID, but the collection
+    is only locked once for the whole batch.
+    @note  You are responsible for releasing each non-NULL document written to \p outDocs.
+    @param collection  The collection.
+    @param docIDs  An array of document ID strings.
+    @param outDocs  A caller-allocated array with room for `FLArray_Count(docIDs)` documents.
+                    On success, each entry is set to the document with the corresponding ID,
+                    or NULL if that document doesn't exist.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred (in which case nothing is written to
+             \p outDocs.) */
+bool CBLCollection_GetDocuments(const CBLCollection* collection,
+                                FLArray docIDs,
+                                const CBLDocument* _cbl_nullable * outDocs,
+                                CBLError* _cbl_nullable outError) CBLAPI;
+
+/** The current revision of a document, as passed to a \ref CBLDocumentReadCallback.
+    @warning  The strings and the properties are only valid until the callback returns. If you
+              need to use any of them afterwards, you must copy them (or retain the properties
+              by calling \ref FLValue_Retain.) */
+typedef struct {
+    FLString docID;         ///< The document ID
+    FLString revisionID;    ///< The revision ID
+    uint64_t sequence;      ///< The revision's sequence in the local database
+    uint64_t timestamp;     ///< The hybrid logical timestamp in nanoseconds that the revision was created
+    FLDict properties;      ///< The revision's properties
+} CBLDocumentRevisionInfo;
+
+/** A callback that reads a document's current revision, passed to \ref CBLCollection_ReadDocument.
+    @param context  The value of the `context` parameter.
+    @param revision  The document's current revision. */
+typedef void (*CBLDocumentReadCallback)(void* _cbl_nullable context,
+                                        const CBLDocumentRevisionInfo* revision);
+
+/** Reads a document's current revision without creating a \ref CBLDocument, by passing its
+    properties and metadata directly to a callback. This avoids allocating a document object, so
+    it's faster than \ref CBLCollection_GetDocument when you only need to read a few properties.
+    @note  The callback is called on the current thread, before this function returns. The
+           collection is not locked while the callback runs. \ref FLDict_GetBlob works on the
+           properties' blobs until the callback returns.
+    @warning  The callback must not call \ref CBLDatabase_SetReaderPoolSize, since the revision
+              may be read by one of the database's readers, which can't be closed until the
+              callback returns.
+    @param collection  The collection.
+    @param docID  The ID of the document.
+    @param callback  The callback to be called with the document's current revision.
+    @param context  An arbitrary value to be passed to the \p callback.
+    @param outError  On failure, the error will be written here. (A nonexistent document is not
+                    considered a failure; in that event the error code will be zero.)
+    @return  True if the document exists and the callback was called, false if the document
+             doesn't exist or an error occurred. */
+bool CBLCollection_ReadDocument(const CBLCollection* collection,
+                                FLString docID,
+                                CBLDocumentReadCallback callback,
+                                void* _cbl_nullable context,
+                                CBLError* _cbl_nullable outError) CBLAPI;
+
 /** Saves a (mutable) document to the collection.
     @warning  If a newer revision has been saved since the doc was loaded, it will be
               overwritten by this one. This can lead to data loss! To avoid this, call
@@ -247,6 +314,103 @@ bool CBLCollection_SaveDocumentWithConflictHandler(CBLCollection* collection,
                                                    void* _cbl_nullable context,
                                                    CBLError* _cbl_nullable outError) CBLAPI;
 
+/** Saves multiple (mutable) documents to the collection in a single transaction.
+    This is much faster than saving each document separately, since the collection is only
+    locked once and the changes are committed to disk once.
+    If a conflicting revision of a document has been saved since it was loaded, the
+    \p concurrency parameter specifies whether that document should be skipped, or the
+    conflicting revision should be overwritten with the revision being saved. A conflict
+    doesn't cause the other documents to fail to save.
+    @note  Each document should only appear once in \p docs.
+    @param collection  The collection to save to.
+    @param docs  The mutable documents to save.
+    @param count  The number of documents in \p docs.
+    @param concurrency  Conflict-handling strategy (fail or overwrite).
+    @param outResults  If non-NULL, an array with room for \p count results. Each entry will be
+                       set to true if the corresponding document was saved, or false if it was
+                       not saved due to a conflict.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred (in which case none of the documents
+             were saved.) */
+bool CBLCollection_SaveDocuments(CBLCollection* collection,
+                                 CBLDocument* const * docs,
+                                 size_t count,
+                                 CBLConcurrencyControl concurrency,
+                                 bool* _cbl_nullable outResults,
+                                 CBLError* _cbl_nullable outError) CBLAPI;
+
+/** A callback that's invoked when a save queued by \ref CBLCollection_SaveDocumentAsync finishes.
+    @param context  The value given when the save was queued.
+    @param doc  The document being saved.
+    @param saved  True if the document was saved, false if it wasn't.
+    @param error  If \p saved is false, the reason; a conflict is reported as \ref kCBLErrorConflict. */
+typedef void (*CBLSaveCompletionCallback)(void* _cbl_nullable context,
+                                          CBLDocument* doc,
+                                          bool saved,
+                                          CBLError error);
+
+/** Queues a (mutable) document to be saved asynchronously by the database's writer thread.
+    The writer thread coalesces saves queued by any number of threads into a single transaction,
+    so that they share a single commit to disk. A batch is committed once it's full, or once the
+    oldest save in it has waited for the queue's latency window; see
+    \ref CBLDatabase_SetWriteQueueOptions. Each save in a batch succeeds or fails independently:
+    one that fails, e.g. with a conflict, doesn't prevent the others from being committed.
+    While a transaction is open (\ref CBLDatabase_BeginTransaction), the writer thread waits for
+    it to end, so that the saves aren't rolled back along with it.
+    
+    The completion callback is invoked after the batch's transaction has been committed. Like
+    change listeners, it's invoked on the writer thread, unless notifications are buffered by
+    \ref CBLDatabase_BufferNotifications.
+    @warning  The document must not be modified until the completion callback has been invoked.
+    @note  Pending saves are committed before the database is closed.
+    @param collection  The collection to save to.
+    @param doc  The mutable document to save. It will be retained until the save finishes.
+    @param concurrency  Conflict-handling strategy (fail or overwrite).
+    @param completion  The callback to be invoked when the save has finished, or NULL.
+    @param context  An arbitrary value to be passed to the \p completion callback.
+    @param outError  On failure, the error will be written here.
+    @return  True if the save was queued, false if the document can't be saved (e.g. it's immutable
+             or belongs to another collection) or the database is closed. */
+bool CBLCollection_SaveDocumentAsync(CBLCollection* collection,
+                                     CBLDocument* doc,
+                                     CBLConcurrencyControl concurrency,
+                                     CBLSaveCompletionCallback _cbl_nullable completion,
+                                     void* _cbl_nullable context,
+                                     CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Updates a document by applying a [JSON Merge Patch](https://www.rfc-editor.org/rfc/rfc7396)
+    to its current revision: each key in the patch replaces the document's property of the same
+    name, a `null` value removes the property, and a nested dictionary is applied recursively as
+    a patch to the property's value. If the document doesn't exist or is deleted, the patch is
+    applied to an empty document, creating it.
+    
+    The current revision is read and the new revision is saved under a single lock of the
+    collection, inside a single transaction, so the patch can't conflict with another change.
+    This is much more efficient than reading, modifying and saving a \ref CBLDocument when there
+    are frequent concurrent updates of the same document.
+    @param collection  The collection.
+    @param docID  The ID of the document.
+    @param patch  The merge patch to apply.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred. */
+bool CBLCollection_PatchDocument(CBLCollection* collection,
+                                 FLString docID,
+                                 FLDict patch,
+                                 CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Updates a document by applying a [JSON Merge Patch](https://www.rfc-editor.org/rfc/rfc7396)
+    given as JSON, which must be an object.
+    (This function is otherwise identical to \ref CBLCollection_PatchDocument.)
+    @param collection  The collection.
+    @param docID  The ID of the document.
+    @param jsonPatch  The merge patch to apply, as JSON.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred. */
+bool CBLCollection_PatchDocumentWithJSON(CBLCollection* collection,
+                                         FLString docID,
+                                         FLString jsonPatch,
+                                         CBLError* _cbl_nullable outError) CBLAPI;
+
 /** Deletes a document from the collection. Deletions are replicated.
     @warning  You are still responsible for releasing the CBLDocument.
     @param collection  The collection containing the document.
@@ -294,6 +458,38 @@ bool CBLCollection_PurgeDocumentByID(CBLCollection* collection,
                                      FLString docID,
                                      CBLError* _cbl_nullable outError) CBLAPI;
 
+/** Deletes multiple documents, given their IDs, in a single transaction.
+    This is much faster than deleting each document separately, since the collection is only
+    locked once and the changes are committed to disk once. Deletions are replicated.
+    @param collection  The collection.
+    @param docIDs  An array of document ID strings.
+    @param outResults  If non-NULL, an array with room for `FLArray_Count(docIDs)` results. Each
+                       entry will be set to true if the corresponding document was deleted, or
+                       false if it doesn't exist or is already deleted.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred (in which case none of the documents
+             were deleted.) */
+bool CBLCollection_DeleteDocuments(CBLCollection* collection,
+                                   FLArray docIDs,
+                                   bool* _cbl_nullable outResults,
+                                   CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Purges multiple documents, given their IDs, in a single transaction.
+    This is much faster than purging each document separately, since the collection is only
+    locked once and the changes are committed to disk once. Purges are _not_ replicated.
+    @param collection  The collection.
+    @param docIDs  An array of document ID strings.
+    @param outResults  If non-NULL, an array with room for `FLArray_Count(docIDs)` results. Each
+                       entry will be set to true if the corresponding document was purged, or
+                       false if it doesn't exist.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred (in which case none of the documents
+             were purged.) */
+bool CBLCollection_PurgeDocuments(CBLCollection* collection,
+                                  FLArray docIDs,
+                                  bool* _cbl_nullable outResults,
+                                  CBLError* _cbl_nullable outError) CBLAPI;
+
 /** Returns the time, if any, at which a given document will expire and be purged.
     Documents don't normally expire; you have to call \ref CBLCollection_SetDocumentExpiration
     to set a document's expiration time.
@@ -341,6 +537,275 @@ CBLDocument* _cbl_nullable CBLCollection_GetMutableDocument(CBLCollection* colle
                                                             CBLError* _cbl_nullable outError) CBLAPI;
 /** @} */
 
+/** \name  Document Cache
+    @{
+    An optional, size-bounded cache of immutable documents, for collections whose documents are
+    read much more often than they're changed. While the cache is enabled,
+    \ref CBLCollection_GetDocument returns the cached \ref CBLDocument instance if there is one,
+    instead of reading the document from the database again. A cached document is removed as
+    soon as the document is changed or purged, by this or any other database connection; when
+    the cache is full, the least recently used document is removed. The cache isn't used while a
+    transaction is open (\ref CBLDatabase_BeginTransaction).
+    @note  A cached document is shared by everyone who got it from the cache, so deleting it with
+           \ref CBLCollection_DeleteDocument doesn't change that instance.
+    @note  The cache belongs to the \ref CBLCollection instance it was enabled on, which is the
+           collection of the cached documents; other instances of the same collection don't use
+           it. The cached documents keep that instance alive until the cache is disabled or the
+           database is closed.
+ */
+
+/** Document cache statistics, returned by \ref CBLCollection_GetDocumentCacheStats. */
+typedef struct {
+    uint64_t hits;          ///< The number of lookups that found the document in the cache
+    uint64_t misses;        ///< The number of lookups that didn't find the document in the cache
+    uint64_t evictions;     ///< The number of documents removed to stay within the capacity
+    uint64_t invalidations; ///< The number of documents removed because they changed
+    size_t count;           ///< The number of documents currently in the cache
+    size_t capacity;        ///< The maximum number of documents in the cache
+} CBLDocumentCacheStats;
+
+/** Enables, resizes or disables the collection's document cache.
+    @param collection  The collection.
+    @param capacity  The maximum number of documents to cache, or 0 to disable and clear the cache.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred. */
+bool CBLCollection_SetDocumentCacheCapacity(CBLCollection* collection,
+                                            size_t capacity,
+                                            CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Returns the collection's document cache statistics. */
+CBLDocumentCacheStats CBLCollection_GetDocumentCacheStats(const CBLCollection* collection) CBLAPI;
+
+/** @} */
+
+/** \name  Bulk Import
+    @{
+    Importing documents in bulk from [JSON Lines](https://jsonlines.org) data, where each line
+    is a JSON object that becomes the body of one document. This is much faster than creating
+    and saving a \ref CBLDocument per line, since each line is converted directly to a document
+    revision and the documents are saved in batches, one transaction per batch.
+ */
+
+/** A callback that supplies JSON Lines data to \ref CBLCollection_ImportJSONLines.
+    @param context  The value of the `readerContext` parameter.
+    @param buffer  Where to copy the data.
+    @param bufferSize  The maximum number of bytes to copy.
+    @return  The number of bytes copied, 0 at the end of the data, or -1 if reading failed. */
+typedef int64_t (*CBLJSONLinesReader)(void* _cbl_nullable context,
+                                      void* buffer,
+                                      size_t bufferSize);
+
+/** A callback reporting the progress of a JSON Lines import, called after each batch of documents
+    has been committed.
+    @param context  The value of the `progressContext` option.
+    @param docCount  The total number of documents imported so far.
+    @return  True to continue importing, or false to stop. */
+typedef bool (*CBLImportProgressCallback)(void* _cbl_nullable context,
+                                          uint64_t docCount);
+
+/** Options for importing JSON Lines data. */
+typedef struct {
+    /** The key path of the document ID in each JSON object, such as `id` or `meta.id`.
+        The value at the key path must be a string. If not specified, a unique document ID will
+        be generated for each document. */
+    FLString docIDKeyPath;
+    
+    /** The number of documents saved per transaction. The default value is 1000. */
+    unsigned commitEvery;
+    
+    /** An optional callback reporting the progress of the import. */
+    CBLImportProgressCallback _cbl_nullable progress;
+    
+    /** An arbitrary value to be passed to the \ref progress callback. */
+    void* _cbl_nullable progressContext;
+} CBLImportJSONLinesOptions;
+
+/** Imports documents from JSON Lines data supplied by a reader callback.
+    Blank lines are skipped. If a document with the same ID already exists, it is overwritten.
+    @note  The batches that were committed before an error occurred, or before the progress
+           callback stopped the import, remain saved. A line that isn't valid JSON fails with a
+           Fleece error, and one that isn't a JSON object with \ref kCBLErrorInvalidParameter.
+    @param collection  The collection to import into.
+    @param reader  The callback supplying the JSON Lines data.
+    @param readerContext  An arbitrary value to be passed to the \p reader.
+    @param options  The import options, or NULL for the default options.
+    @param outDocCount  If non-NULL, the number of imported documents will be written here.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred. */
+bool CBLCollection_ImportJSONLines(CBLCollection* collection,
+                                   CBLJSONLinesReader reader,
+                                   void* _cbl_nullable readerContext,
+                                   const CBLImportJSONLinesOptions* _cbl_nullable options,
+                                   uint64_t* _cbl_nullable outDocCount,
+                                   CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Imports documents from a JSON Lines file.
+    (This function is otherwise identical to \ref CBLCollection_ImportJSONLines.)
+    @param collection  The collection to import into.
+    @param path  The path of the JSON Lines file.
+    @param options  The import options, or NULL for the default options.
+    @param outDocCount  If non-NULL, the number of imported documents will be written here.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred. */
+bool CBLCollection_ImportJSONLinesFile(CBLCollection* collection,
+                                       FLString path,
+                                       const CBLImportJSONLinesOptions* _cbl_nullable options,
+                                       uint64_t* _cbl_nullable outDocCount,
+                                       CBLError* _cbl_nullable outError) CBLAPI;
+
+/** @} */
+
+/** \name  Document Enumeration
+    @{
+    A \ref CBLDocumentEnumerator scans the documents in a collection directly, without compiling
+    and running a query. It's useful for exporting or reprocessing a whole collection.
+ */
+
+/** The order in which a \ref CBLDocumentEnumerator returns documents. */
+typedef CBL_ENUM(uint8_t, CBLDocumentEnumeratorOrder) {
+    kCBLEnumerateByDocID,       ///< Ascending order of document ID
+    kCBLEnumerateBySequence,    ///< Ascending order of sequence, i.e. of the last time saved
+};
+
+/** Options for enumerating the documents in a collection. */
+typedef struct {
+    /** The order of the documents. The default is \ref kCBLEnumerateByDocID. */
+    CBLDocumentEnumeratorOrder order;
+    
+    /** When enumerating by sequence, only documents whose sequence is greater than this
+        will be returned. */
+    uint64_t sinceSequence;
+    
+    /** When enumerating by document ID, the minimum document ID (inclusive) to return. */
+    FLString startDocID;
+    
+    /** When enumerating by document ID, the maximum document ID (inclusive) to return. */
+    FLString endDocID;
+    
+    /** If true, deleted documents will also be returned. */
+    bool includeDeleted;
+    
+    /** If true, only the documents' metadata will be read; \ref CBLDocumentEnumerator_Properties
+        will return NULL. This is much faster when the documents' properties aren't needed. */
+    bool metadataOnly;
+    
+    /** The number of documents read from the database at a time. The default value is 100.
+        The collection is only locked while reading each batch. The documents skipped before
+        `startDocID` count toward the batch size too. */
+    unsigned batchSize;
+} CBLDocumentEnumeratorOptions;
+
+CBL_REFCOUNTED(CBLDocumentEnumerator*, DocumentEnumerator);
+
+/** Creates an enumerator over the documents in a collection.
+    @note  You are responsible for releasing the returned enumerator.
+    @param collection  The collection.
+    @param options  The enumeration options, or NULL for the default options.
+    @param outError  On failure, the error will be written here.
+    @return  A new enumerator, positioned before the first document, or NULL on failure. */
+_cbl_warn_unused
+CBLDocumentEnumerator* _cbl_nullable CBLCollection_EnumerateDocuments(const CBLCollection* collection,
+                                                                      const CBLDocumentEnumeratorOptions* _cbl_nullable options,
+                                                                      CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Moves the enumerator to the next document.
+    This must be called before accessing the first document.
+    @param enumerator  The enumerator.
+    @param outError  On failure, the error will be written here. (Reaching the end is not
+                    considered a failure; in that event the error code will be zero.)
+    @return  True if there is a document, false at the end or if an error occurred. */
+bool CBLDocumentEnumerator_Next(CBLDocumentEnumerator* enumerator,
+                                CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Returns the current document's ID. */
+FLString CBLDocumentEnumerator_DocumentID(const CBLDocumentEnumerator*) CBLAPI;
+
+/** Returns the current document's revision ID. */
+FLString CBLDocumentEnumerator_RevisionID(const CBLDocumentEnumerator*) CBLAPI;
+
+/** Returns the current document's sequence in the local database. */
+uint64_t CBLDocumentEnumerator_Sequence(const CBLDocumentEnumerator*) CBLAPI;
+
+/** Returns true if the current document is deleted. */
+bool CBLDocumentEnumerator_IsDeleted(const CBLDocumentEnumerator*) CBLAPI;
+
+/** Returns the current document's properties, or NULL if the enumerator only reads metadata.
+    @warning  The dict reference is only valid until the enumerator is advanced or released.
+              If you want to keep it for longer, call \ref FLDict_Retain (and release it when done.) */
+FLDict _cbl_nullable CBLDocumentEnumerator_Properties(const CBLDocumentEnumerator*) CBLAPI;
+
+/** Returns the current document as a new (immutable) \ref CBLDocument.
+    @note  You are responsible for releasing the returned document.
+    @param enumerator  The enumerator.
+    @param outError  On failure, the error will be written here. (If the document has been deleted
+                    or purged since the enumerator read it, this is not considered a failure; in
+                    that event the error code will be zero.)
+    @return  A new \ref CBLDocument instance, or NULL if the document doesn't exist or an error occurred. */
+_cbl_warn_unused
+const CBLDocument* _cbl_nullable CBLDocumentEnumerator_GetDocument(const CBLDocumentEnumerator* enumerator,
+                                                                   CBLError* _cbl_nullable outError) CBLAPI;
+
+/** @} */
+
+/** \name  Changes Feed
+    @{
+    Reading the changes made to a collection since a given sequence, in the order they were made.
+    Unlike a \ref CBLCollectionChangeListener, the changes can be read at any time, so a process
+    can resume reading where it left off by persisting the \ref CBLChangeBatch_LastSequence of the
+    last batch it processed.
+    @note  Only the latest change to each document is returned; a document that was saved several
+           times since the given sequence appears once, at its current sequence.
+ */
+
+/** Flags for \ref CBLCollection_GetChangesSince. */
+typedef CBL_OPTIONS(uint32_t, CBLChangesFlags) {
+    kCBLChangesIncludeDeleted   = 1 << 0,   ///< Include documents that have been deleted
+};
+
+/** Information about a changed document, in a \ref CBLChangeBatch. */
+typedef struct {
+    FLString docID;         ///< The document ID
+    FLString revisionID;    ///< The current revision ID
+    uint64_t sequence;      ///< The current sequence
+    bool deleted;           ///< True if the document is deleted
+    uint64_t bodySize;      ///< The size in bytes of the current revision's encoded body
+} CBLChangedDocument;
+
+CBL_REFCOUNTED(CBLChangeBatch*, ChangeBatch);
+
+/** Reads the documents that have changed since a given sequence, in sequence order.
+    @note  You are responsible for releasing the returned batch.
+    @param collection  The collection.
+    @param sinceSequence  Only documents whose sequence is greater than this are returned. Pass 0
+                          to read all the documents, or the \ref CBLChangeBatch_LastSequence of
+                          the previous batch to continue from it.
+    @param limit  The maximum number of changes to return, or 0 for no limit.
+    @param flags  Flags for the changes to return.
+    @param outError  On failure, the error will be written here.
+    @return  A new batch of changes, which is empty if there are no more changes, or NULL on failure. */
+_cbl_warn_unused
+CBLChangeBatch* _cbl_nullable CBLCollection_GetChangesSince(const CBLCollection* collection,
+                                                            uint64_t sinceSequence,
+                                                            unsigned limit,
+                                                            CBLChangesFlags flags,
+                                                            CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Returns the number of changes in the batch. */
+size_t CBLChangeBatch_Count(const CBLChangeBatch*) CBLAPI;
+
+/** Returns the change at the given index.
+    @warning  The returned struct is owned by the batch, and is only valid until the batch is released.
+    @param batch  The batch.
+    @param index  The index, which must be less than \ref CBLChangeBatch_Count.
+    @return  The change at the given index. */
+const CBLChangedDocument* CBLChangeBatch_Get(const CBLChangeBatch* batch, size_t index) CBLAPI;
+
+/** Returns the sequence to continue from, i.e. the sequence of the last change in the batch,
+    or the `sinceSequence` the batch was read with if it's empty. */
+uint64_t CBLChangeBatch_LastSequence(const CBLChangeBatch*) CBLAPI;
+
+/** @} */
+
 /** \name  Query Indexes
     @{
  */
@@ -92,6 +92,15 @@ typedef struct {
         power failure will not cause the loss of any data.  FULL synchronous
         is very safe but it is also dramatically slower. */
     bool fullSync;
+
+    /** Declares that the database, and every object obtained from it, will only ever be used by
+        the thread that opened it. This skips the locking that otherwise makes it safe to use the
+        database from multiple threads.
+
+        A single-threaded database can't be used with features that call into it from other
+        threads: replicators, query change listeners, and asynchronous saves. Debug builds of
+        the library assert if the database is used by more than one thread. */
+    bool singleThreaded;
 } CBLDatabaseConfiguration;
 
 /** Returns the default database configuration. */
@@ -204,6 +213,42 @@ bool CBLDatabase_EndTransaction(CBLDatabase*,
                                 bool commit,
                                 CBLError* _cbl_nullable outError) CBLAPI;
 
+/** How soon a committed transaction is synced to disk, so that it survives an OS crash or power
+    failure. (A committed transaction always survives a crash of the application itself.) */
+typedef CBL_ENUM(uint8_t, CBLDurability) {
+    /** No extra sync: the database's \ref CBLDatabaseConfiguration.fullSync setting applies.
+        Without full sync, the transaction is synced by SQLite's next WAL checkpoint. */
+    kCBLDurabilityNone,
+    /** Synced by a background thread within the deferred durability interval, together with
+        the other deferred transactions committed in that interval. */
+    kCBLDurabilityDeferred,
+    /** Synced before the call returns. */
+    kCBLDurabilityImmediate,
+};
+
+/** Ends a transaction, either committing or aborting, and if it commits, syncs it to disk
+    according to \p durability.
+    @note  When transactions are nested, the outermost one commits to disk, with the strongest
+           durability requested by any of them.
+    @note  If the changes were committed but couldn't be synced, this returns false with an error.
+    @note  A single-threaded database has no background thread, so it syncs a transaction
+           committed with \ref kCBLDurabilityDeferred immediately instead.
+    @param db  The database.
+    @param commit  True to commit the changes, false to abort them.
+    @param durability  How soon to sync the changes to disk.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false on failure. */
+bool CBLDatabase_EndTransactionWithDurability(CBLDatabase* db,
+                                              bool commit,
+                                              CBLDurability durability,
+                                              CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Sets the longest time between committing a transaction with \ref kCBLDurabilityDeferred and
+    syncing it to disk; that is, how many milliseconds of such transactions can be lost by an OS
+    crash or power failure. The default is 50ms. */
+void CBLDatabase_SetDeferredDurabilityInterval(CBLDatabase* db,
+                                               unsigned intervalMS) CBLAPI;
+
 #ifdef COUCHBASE_ENTERPRISE
 /** Encrypts or decrypts a database, or changes its encryption key.
 
@@ -241,6 +286,84 @@ bool CBLDatabase_PerformMaintenance(CBLDatabase* db,
                                     CBLMaintenanceType type,
                                     CBLError* _cbl_nullable outError) CBLAPI;
 
+/** Sets the number of read-only connections in the database's reader pool. Zero, the default,
+    disables the pool.
+    
+    Normally every read and write on a \ref CBLDatabase, and its collections, is serialized by a
+    single lock. Reader connections on the same database file let \ref CBLCollection_ReadDocument,
+    document counts and query execution run concurrently with each other and with writes.
+    (\ref CBLDocument objects are always read by the database's own connection, which they keep
+    using after they're read.) A read uses the
+    database's own connection instead whenever all readers are busy, or a transaction started by
+    \ref CBLDatabase_BeginTransaction is open, since readers can't see its uncommitted changes.
+    @note  Readers see the last committed state of the database: a read on one thread is never
+           affected by a transaction in progress on another thread.
+    @note  Resizing waits for the reads in progress to finish. */
+bool CBLDatabase_SetReaderPoolSize(CBLDatabase* db,
+                                   unsigned size,
+                                   CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Returns the number of read-only connections in the database's reader pool. */
+unsigned CBLDatabase_ReaderPoolSize(const CBLDatabase* db) CBLAPI;
+
+/** Statistics of one category of operations that lock a database. Times are in nanoseconds. */
+typedef struct {
+    uint64_t acquisitions;      ///< The number of times the lock was acquired
+    uint64_t totalWaitNS;       ///< The total time spent waiting to acquire the lock
+    uint64_t maxWaitNS;         ///< The longest time spent waiting to acquire the lock
+    uint64_t totalHoldNS;       ///< The total time the lock was held
+    uint64_t maxHoldNS;         ///< The longest time the lock was held
+    /** Histogram of hold times; the buckets are < 10µs, < 100µs, < 1ms, < 10ms, < 100ms
+        and >= 100ms. */
+    uint64_t holdHistogram[6];
+} CBLLockCategoryStats;
+
+/** Lock contention statistics of a database, returned by \ref CBLDatabase_GetLockStats.
+    The database and its collections share a single lock. */
+typedef struct {
+    CBLLockCategoryStats documentRead;  ///< Getting documents and counts, enumerating, changes
+    CBLLockCategoryStats documentWrite; ///< Saving, deleting, purging and importing documents
+    CBLLockCategoryStats query;         ///< Compiling and running queries
+    CBLLockCategoryStats index;         ///< Creating, deleting, listing and updating indexes
+    CBLLockCategoryStats observer;      ///< Adding and removing change observers
+    CBLLockCategoryStats transaction;   ///< Beginning, committing and aborting transactions
+} CBLLockStats;
+
+/** Enables or disables the recording of lock contention statistics, which is disabled by default.
+    Recording adds two clock reads to each lock acquisition. */
+void CBLDatabase_SetLockStatsEnabled(CBLDatabase* db, bool enabled) CBLAPI;
+
+/** Returns the lock contention statistics recorded since they were enabled or last reset. */
+CBLLockStats CBLDatabase_GetLockStats(const CBLDatabase* db) CBLAPI;
+
+/** Resets the lock contention statistics to zero. */
+void CBLDatabase_ResetLockStats(CBLDatabase* db) CBLAPI;
+
+/** Options for the database's write queue, which commits the saves queued by
+    \ref CBLCollection_SaveDocumentAsync. */
+typedef struct {
+    /** The maximum number of saves committed in a single transaction. (Default: 100) */
+    unsigned maxBatchSize;
+    
+    /** The maximum time, in milliseconds, that a queued save waits for more saves to join its
+        transaction. Zero commits whatever has been queued as soon as possible. (Default: 10) */
+    unsigned maxLatencyMS;
+} CBLWriteQueueOptions;
+
+/** Sets the options of the database's write queue. They apply to batches that haven't started
+    committing yet. */
+bool CBLDatabase_SetWriteQueueOptions(CBLDatabase* db,
+                                      const CBLWriteQueueOptions* options,
+                                      CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Blocks until all saves queued by \ref CBLCollection_SaveDocumentAsync before this call have
+    been committed, and their completion callbacks have been invoked or queued.
+    Fails with \ref kCBLErrorTransactionNotClosed if a transaction is open, since the queued
+    saves aren't committed until it ends.
+    @warning  Must not be called from a completion callback. */
+bool CBLDatabase_FlushWriteQueue(CBLDatabase* db,
+                                 CBLError* _cbl_nullable outError) CBLAPI;
+
 /** @} */
 
 #ifdef __APPLE__
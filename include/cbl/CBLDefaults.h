@@ -44,6 +44,9 @@ CBL_PUBLIC extern const bool kCBLDefaultDatabaseFullSync;
 /** [false] Memory mapped database files are enabled by default */
 CBL_PUBLIC extern const bool kCBLDefaultDatabaseMmapDisabled;
 
+/** [false] Databases can be used from multiple threads by default */
+CBL_PUBLIC extern const bool kCBLDefaultDatabaseSingleThreaded;
+
 /** @} */
 
 /** \name CBLLogFileConfiguration
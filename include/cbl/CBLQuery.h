@@ -66,6 +66,35 @@ CBLQuery* _cbl_nullable CBLDatabase_CreateQuery(const CBLDatabase* db,
 
 CBL_REFCOUNTED(CBLQuery*, Query);
 
+/** Compiled query cache statistics, returned by \ref CBLDatabase_GetQueryCacheStats. */
+typedef struct {
+    uint64_t hits;          ///< The number of queries created without being compiled
+    uint64_t misses;        ///< The number of queries that had to be compiled
+    uint64_t evictions;     ///< The number of queries removed to stay within the capacity
+    size_t count;           ///< The number of compiled queries currently in the cache
+    size_t capacity;        ///< The maximum number of compiled queries in the cache
+} CBLQueryCacheStats;
+
+/** Enables, resizes or disables the database's compiled query cache. The cache is disabled
+    by default.
+
+    When enabled, \ref CBLDatabase_CreateQuery looks up the query language and string in a
+    least-recently-used cache before compiling it. Every \ref CBLQuery created from the same string
+    shares the compiled query, but has its own parameters; a query that gets a change listener
+    is recompiled, so that its listener isn't affected by the others. Creating or deleting an
+    index, or deleting a collection, clears the cache.
+    @param db  The database.
+    @param capacity  The maximum number of compiled queries to cache, or 0 to disable and clear
+                    the cache.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, false if an error occurred. */
+bool CBLDatabase_SetQueryCacheCapacity(CBLDatabase* db,
+                                       size_t capacity,
+                                       CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Returns the database's compiled query cache statistics. */
+CBLQueryCacheStats CBLDatabase_GetQueryCacheStats(const CBLDatabase* db) CBLAPI;
+
 /** Assigns values to the query's parameters.
     These values will be substited for those parameters whenever the query is executed,
     until they are next assigned.
@@ -91,6 +120,81 @@ _cbl_warn_unused
 CBLResultSet* _cbl_nullable CBLQuery_Execute(CBLQuery*,
                                              CBLError* _cbl_nullable outError) CBLAPI;
 
+/** A callback that receives the results of one parameter set of \ref CBLQuery_ExecuteBatch.
+    @param context  The `context` parameter that was passed to \ref CBLQuery_ExecuteBatch.
+    @param parameterSetIndex  The index in `parameterSets` of the parameters the query ran with.
+    @param results  The results. They're released when the callback returns, unless it retains them.
+    @return  True to continue with the next parameter set, false to stop. */
+typedef bool (*CBLQueryBatchCallback)(void* _cbl_nullable context,
+                                      unsigned parameterSetIndex,
+                                      CBLResultSet* results);
+
+/** Runs the query once for each parameter set in `parameterSets`, an array of dictionaries like
+    the one given to \ref CBLQuery_SetParameters, and passes each one's results to the callback,
+    in order. This is faster than setting the parameters and executing the query for each set.
+    The query's own parameters aren't changed.
+    @note  An element that isn't a dictionary fails the call before the query is run at all.
+    @param query  The query.
+    @param parameterSets  An array of parameter dictionaries.
+    @param callback  The callback that receives the results of each parameter set.
+    @param context  An arbitrary value to be passed to the callback.
+    @param outError  On failure, the error will be written here.
+    @return  True on success, including when the callback stops early; false on failure. */
+bool CBLQuery_ExecuteBatch(CBLQuery* query,
+                           FLArray parameterSets,
+                           CBLQueryBatchCallback callback,
+                           void* _cbl_nullable context,
+                           CBLError* _cbl_nullable outError) CBLAPI;
+
+/** A callback that's invoked when a query run by \ref CBLQuery_ExecuteAsync finishes.
+    @param context  The value given to \ref CBLQuery_ExecuteAsync.
+    @param results  The query results, or NULL on failure. They're released after the callback
+                    returns, unless it retains them with \ref CBLResultSet_Retain.
+    @param error  If \p results is NULL, the reason: the query failed, or the database was
+                    closed; or it was canceled (`ECANCELED` in the POSIX domain), or its
+                    timeout expired (`ETIMEDOUT` in the POSIX domain.) */
+typedef void (*CBLQueryCompletionCallback)(void* _cbl_nullable context,
+                                           CBLResultSet* _cbl_nullable results,
+                                           CBLError error);
+
+/** Runs the query asynchronously on one of the database's query worker threads. The query uses
+    the parameters it has when it starts running, so don't change them until it has finished.
+
+    The completion callback is invoked exactly once: when the query has run, when the task is
+    canceled by \ref CBLQueryTask_Cancel, or when the timeout expires, whichever happens first.
+    Like change listeners, it's invoked on a background thread, unless notifications are buffered
+    by \ref CBLDatabase_BufferNotifications.
+    @note  A query that has started running can't be interrupted: a canceled or timed-out query
+           that had already started keeps its worker busy until it ends, and its results are
+           then discarded. Use a reader pool (\ref CBLDatabase_SetReaderPoolSize) so that
+           long-running queries don't block other reads.
+    @note  Not available for single-threaded databases.
+    @param query  The query.
+    @param timeoutMS  The longest time, in milliseconds, to wait for the results, or 0 for no limit.
+    @param completion  The callback to invoke with the results.
+    @param context  An arbitrary value to be passed to the \p completion callback.
+    @param outError  On failure, the error will be written here.
+    @return  The task, which must be released when no longer needed, or NULL if the query
+             couldn't be queued, e.g. because the database is closed. The completion callback
+             is invoked even if the task is released first. */
+_cbl_warn_unused
+CBLQueryTask* _cbl_nullable CBLQuery_ExecuteAsync(CBLQuery* query,
+                                                  unsigned timeoutMS,
+                                                  CBLQueryCompletionCallback completion,
+                                                  void* _cbl_nullable context,
+                                                  CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Cancels an asynchronous query: its completion callback is invoked with an `ECANCELED`
+    error, unless it has already been invoked. */
+void CBLQueryTask_Cancel(CBLQueryTask* task) CBLAPI;
+
+CBL_REFCOUNTED(CBLQueryTask*, QueryTask);
+
+/** Enables or disables profiling of the query's executions, which is disabled by default.
+    While enabled, each \ref CBLResultSet returned by \ref CBLQuery_Execute records the statistics
+    returned by \ref CBLResultSet_Stats. Profiling adds a few clock reads to each execution. */
+void CBLQuery_SetProfilingEnabled(CBLQuery* query, bool enabled) CBLAPI;
+
 /** Returns information about the query, including the translated SQLite form, and the search
     strategy. You can use this to help optimize the query: the word `SCAN` in the strategy
     indicates a linear scan of the entire database, which should be avoided by adding an index.
@@ -111,6 +215,12 @@ unsigned CBLQuery_ColumnCount(const CBLQuery*) CBLAPI;
 FLSlice CBLQuery_ColumnName(const CBLQuery*,
                             unsigned columnIndex) CBLAPI;
 
+/** Returns the index of the column with the given name, or -1 if there's no such column.
+    Looking up a column's index once, then calling \ref CBLResultSet_ValueAtIndex for each
+    result, is faster than calling \ref CBLResultSet_ValueForKey. */
+int CBLQuery_ColumnIndex(const CBLQuery*,
+                         FLString name) CBLAPI;
+
 /** @} */
 
 
@@ -147,6 +257,14 @@ bool CBLResultSet_Next(CBLResultSet*) CBLAPI;
 FLValue _cbl_nullable CBLResultSet_ValueAtIndex(const CBLResultSet*,
                                                 unsigned index) CBLAPI;
 
+/** Stores the values of the current result's columns in `outValues`, without allocating
+    anything, and returns the number of values stored: the lesser of `maxColumns` and the
+    query's column count. A NULL value indicates `MISSING`, as in \ref CBLResultSet_ValueAtIndex.
+    @warning The values are only valid until the result-set is advanced or released. */
+unsigned CBLResultSet_GetColumnValues(const CBLResultSet*,
+                                      FLValue _cbl_nullable outValues[],
+                                      unsigned maxColumns) CBLAPI;
+
 /** Returns the value of a column of the current result, given its name.
     This may return a NULL pointer, indicating `MISSING`, if the value doesn't exist, e.g. if
     the column is a property that doesn't exist in the document. (Or, of course, if the key
@@ -156,11 +274,16 @@ FLValue _cbl_nullable CBLResultSet_ValueForKey(const CBLResultSet*,
                                                FLString key) CBLAPI;
 
 /** Returns the current result as an array of column values.
+    @note  This creates a new array for every result; \ref CBLResultSet_GetColumnValues and
+           \ref CBLResultSet_ValueAtIndex are faster when reading many results.
     @warning The array reference is only valid until the result-set is advanced or released.
             If you want to keep it for longer, call \ref FLArray_Retain (and release it when done.) */
 FLArray CBLResultSet_ResultArray(const CBLResultSet*) CBLAPI;
 
 /** Returns the current result as a dictionary mapping column names to values.
+    @note  This creates a new dictionary for every result. When reading many results, look up
+           the column indexes once with \ref CBLQuery_ColumnIndex and call
+           \ref CBLResultSet_ValueAtIndex instead.
     @warning The dict reference is only valid until the result-set is advanced or released.
             If you want to keep it for longer, call \ref FLDict_Retain (and release it when done.) */
 FLDict CBLResultSet_ResultDict(const CBLResultSet*) CBLAPI;
@@ -168,11 +291,204 @@ FLDict CBLResultSet_ResultDict(const CBLResultSet*) CBLAPI;
 /** Returns the Query that created this ResultSet. */
 CBLQuery* CBLResultSet_GetQuery(const CBLResultSet *rs) CBLAPI;
 
+/** Statistics of one execution of a query, returned by \ref CBLResultSet_Stats.
+    Times are in nanoseconds. Apart from `compileNS`, they're only recorded if profiling was
+    enabled by \ref CBLQuery_SetProfilingEnabled when the query was executed. */
+typedef struct {
+    /** The time taken to compile the query, or 0 if it came from the query cache. */
+    uint64_t compileNS;
+    /** The time \ref CBLQuery_Execute took to run the query. */
+    uint64_t executeNS;
+    /** The time from the start of the execution until the first result was read, or 0. */
+    uint64_t firstRowNS;
+    /** The time from the start of the execution until the end of the results was reached,
+        or 0 if it hasn't been reached yet. */
+    uint64_t enumerationNS;
+    /** The number of results read so far. */
+    uint64_t rowsReturned;
+    /** The number of column values read, by \ref CBLResultSet_ValueAtIndex and the other
+        accessors, including \ref CBLResultSet_NextBatch. */
+    uint64_t valuesRead;
+    /** True if the query ran on a connection from the reader pool, without the database's lock. */
+    bool usedReader;
+    /** True if the query plan includes a scan of all of a collection's documents. */
+    bool fullScan;
+    /** The names of the indexes used by the query plan. This array belongs to the query, and is
+        valid until the query is released. */
+    FLArray _cbl_nullable indexesUsed;
+} CBLQueryStats;
+
+/** Returns the statistics of the execution of the query that produced this result set.
+    Call it after reading the results to get the total enumeration time. */
+CBLQueryStats CBLResultSet_Stats(const CBLResultSet* rs) CBLAPI;
+
+/** The types that \ref CBLResultSet_NextBatch can convert column values to. */
+typedef CBL_ENUM(uint8_t, CBLColumnType) {
+    kCBLColumnInt64,        ///< `int64_t`; numbers and booleans. Fractions are truncated.
+    kCBLColumnDouble,       ///< `double`; numbers and booleans
+    kCBLColumnBool,         ///< `bool`; booleans and numbers (nonzero is true)
+    kCBLColumnString,       ///< `FLSlice`; strings only
+};
+
+/** Specifies a column to be fetched by \ref CBLResultSet_NextBatch. */
+typedef struct {
+    unsigned column;        ///< The (zero-based) index of the column in the query's results
+    CBLColumnType type;     ///< The type to convert the column's values to
+} CBLColumnSpec;
+
+/** Caller-provided storage for one column's values, filled in by \ref CBLResultSet_NextBatch. */
+typedef struct {
+    /** Array of `maxRows` values of the type given by the \ref CBLColumnSpec: `int64_t`,
+        `double`, `bool` or `FLSlice`. */
+    void* values;
+    /** Null bitmap of at least `(maxRows + 7) / 8` bytes, or NULL if not needed. The bit
+        `nulls[row / 8] & (1 << (row % 8))` is set if the value is `MISSING`, null, or can't be
+        converted to the column type; the value in the array is then zero or a null slice. */
+    uint8_t* _cbl_nullable nulls;
+} CBLColumnBuffer;
+
+/** Advances the result set by up to `maxRows` results, and stores the values of the specified
+    columns in the caller's typed arrays. This avoids the cost of calling
+    \ref CBLResultSet_ValueAtIndex and examining the `FLValue` of every column of every row.
+
+    Afterwards the result set is positioned on the last result that was fetched, as though
+    \ref CBLResultSet_Next had been called that many times.
+    @note  String slices point into the result set's data, and remain valid until the result
+           set is released.
+    @param rs  The result set.
+    @param maxRows  The maximum number of results to fetch; the capacity of the buffers.
+    @param columnSpecs  The columns to fetch, and the types to convert their values to.
+    @param outBuffers  An array of `columnCount` buffers, one for each column spec.
+    @param columnCount  The number of column specs and buffers.
+    @param outError  On failure, the error will be written here.
+    @return  The number of results fetched, which is less than `maxRows` only at the end of
+             the results, or zero if there are no more results or an error occurred (e.g. a
+             column index is out of range.) */
+unsigned CBLResultSet_NextBatch(CBLResultSet* rs,
+                                unsigned maxRows,
+                                const CBLColumnSpec* columnSpecs,
+                                CBLColumnBuffer* outBuffers,
+                                unsigned columnCount,
+                                CBLError* _cbl_nullable outError) CBLAPI;
+
+/** The layouts that \ref CBLResultSet_WriteJSON can write results in. */
+typedef CBL_ENUM(uint8_t, CBLResultJSONFormat) {
+    kCBLResultJSONArray,            ///< A JSON array of results
+    kCBLResultJSONLines,            ///< Newline-delimited JSON: one result per line
+};
+
+/** Options for \ref CBLResultSet_WriteJSON. */
+typedef struct {
+    /** The layout of the results. */
+    CBLResultJSONFormat format;
+    /** If true, indents the JSON over multiple lines. Ignored by `kCBLResultJSONLines`. */
+    bool pretty;
+    /** The indexes of the columns to write, or NULL to write all of them. */
+    const unsigned* _cbl_nullable columns;
+    /** The number of items in `columns`. */
+    unsigned columnCount;
+    /** The number of bytes of JSON to buffer before passing them to the callback,
+        or 0 for the default of 16KB. */
+    size_t chunkSize;
+} CBLResultJSONOptions;
+
+/** A callback that receives the JSON written by \ref CBLResultSet_WriteJSON, one chunk at a time.
+    The chunk is only valid until the callback returns.
+    @return  True to continue, false to stop writing. */
+typedef bool (*CBLJSONWriteCallback)(void* _cbl_nullable context, FLSlice chunk);
+
+/** Writes the remaining results as JSON, in chunks passed to a callback, advancing the result
+    set to its end. Each result is written as a dictionary mapping column names to values, like
+    \ref CBLResultSet_ResultDict, without building that dictionary.
+    @param rs  The result set.
+    @param options  The options, or NULL for a compact JSON array of all the columns.
+    @param callback  The callback that receives the JSON.
+    @param context  An arbitrary value to be passed to the callback.
+    @param outError  On failure, the error will be written here. If the callback stops the
+                     writing, the error is `ECANCELED` in the POSIX domain.
+    @return  True on success, false on failure. */
+bool CBLResultSet_WriteJSON(CBLResultSet* rs,
+                            const CBLResultJSONOptions* _cbl_nullable options,
+                            CBLJSONWriteCallback callback,
+                            void* _cbl_nullable context,
+                            CBLError* _cbl_nullable outError) CBLAPI;
+
 CBL_REFCOUNTED(CBLResultSet*, ResultSet);
 
 /** @} */
 
 
+/** \name  Keyset pagination
+    @{
+    Paging through query results with `OFFSET` re-scans all the preceding results, so each page
+    is slower than the one before. Keyset pagination instead resumes each page right after the
+    sort key and document ID of the last result of the previous page, which with an index on the
+    sort key costs the same for every page.
+
+    Create the query for each page with \ref CBLDatabase_CreateKeysetQuery, passing the
+    continuation token of the last result of the previous page, which is returned by
+    \ref CBLResultSet_ContinuationToken. The tokens are small JSON strings that can be returned
+    to a client, and passed back in a later request.
+ */
+
+/** Describes a query whose results are returned one page at a time.
+    The query is assembled as SQL++:
+    `SELECT select FROM collection WHERE where ORDER BY orderBy, meta().id LIMIT pageSize`. */
+typedef struct {
+    /** The collection to query, as in a SQL++ `FROM` clause, e.g. `_` or `store.products`. */
+    FLString collection;
+
+    /** The result columns, as in a SQL++ `SELECT` clause, e.g. `name, price`. Two more columns
+        are added after them: the sort key, and the document ID. */
+    FLString select;
+
+    /** A SQL++ filter expression, or an empty string for none. */
+    FLString where;
+
+    /** The sort key: a single SQL++ expression, e.g. `name`. Create a value index on it, so that
+        pages can start in the middle of the index. Documents whose sort key is null or missing
+        aren't included in the results. */
+    FLString orderBy;
+
+    /** True to sort in descending order. */
+    bool descending;
+
+    /** The maximum number of results per page. */
+    unsigned pageSize;
+
+    /** Values of the parameters used in `where`, or NULL. */
+    FLDict _cbl_nullable parameters;
+} CBLKeysetQueryConfiguration;
+
+/** Creates a query that returns one page of results, starting after the result that the
+    continuation token was created from.
+    @note  You must release the \ref CBLQuery when you're finished with it.
+    @param db  The database to query.
+    @param config  The query's description, which must be the same for every page.
+    @param continuationToken  A token returned by \ref CBLResultSet_ContinuationToken for the
+                    last result of the previous page, or a null slice for the first page.
+    @param outError  On failure, the error will be written here.
+    @return  The new query object. */
+_cbl_warn_unused
+CBLQuery* _cbl_nullable CBLDatabase_CreateKeysetQuery(const CBLDatabase* db,
+                                                      const CBLKeysetQueryConfiguration* config,
+                                                      FLSlice continuationToken,
+                                                      CBLError* _cbl_nullable outError) CBLAPI;
+
+/** Returns a continuation token for the current result of a query created by
+    \ref CBLDatabase_CreateKeysetQuery. It's usually called on the last result of a page, and
+    passed to \ref CBLDatabase_CreateKeysetQuery to create the query for the next page.
+    @note  You are responsible for releasing the result by calling \ref FLSliceResult_Release.
+    @param rs  The result set, which must be positioned on a result.
+    @param outError  On failure, the error will be written here.
+    @return  The token, or a null slice if an error occurred. */
+_cbl_warn_unused
+FLSliceResult CBLResultSet_ContinuationToken(const CBLResultSet* rs,
+                                             CBLError* _cbl_nullable outError) CBLAPI;
+
+/** @} */
+
+
 /** \name  Change listener
     @{
     Adding a change listener to a query turns it into a "live query". When changes are made to
@@ -206,11 +522,11 @@ typedef void (*CBLQueryChangeListener)(void* _cbl_nullable context,
     @param listener  The callback to be invoked.
     @param context  An opaque value that will be passed to the callback.
     @return  A token to be passed to \ref CBLListener_Remove when it's time to remove the
-            listener.*/
+            listener, or NULL if the query belongs to a single-threaded database.*/
 _cbl_warn_unused
-CBLListenerToken* CBLQuery_AddChangeListener(CBLQuery* query,
-                                             CBLQueryChangeListener listener,
-                                             void* _cbl_nullable context) CBLAPI;
+CBLListenerToken* _cbl_nullable CBLQuery_AddChangeListener(CBLQuery* query,
+                                                           CBLQueryChangeListener listener,
+                                                           void* _cbl_nullable context) CBLAPI;
 
 /** Returns the query's _entire_ current result set, after it's been announced via a call to the
     listener's callback.
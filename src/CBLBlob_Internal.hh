@@ -270,6 +270,10 @@ inline const CBLBlob* _cbl_nullable CBLBlob::getBlob(Dict blobDict) noexcept {
     if (!C4Blob::isBlob(blobDict))
         return nullptr;
 
+    // Check if it's a blob in the properties passed to a CBLCollection_ReadDocument callback:
+    if (auto blobs = cbl_internal::ReadDocumentBlobs::attachedTo(C4Document::containingValue(blobDict)); blobs)
+        return blobs->getBlob(blobDict, *key);
+
     // Check if it's a new unsaved blob:
     if (auto newBlob = CBLDocument::findNewBlob(blobDict); newBlob)
         return newBlob;
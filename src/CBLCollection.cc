@@ -19,7 +19,12 @@
 #include "CBLCollection_Internal.hh"
 #include "Internal.hh"
 #include "CBLQueryIndex_Internal.hh"
+#include "c4BlobStore.hh"
+#include "c4DocEnumerator.hh"
 #include "c4Index.hh"
+#include <cctype>
+#include <fstream>
+#include <string>
 
 using namespace fleece;
 using namespace cbl_internal;
@@ -35,6 +40,7 @@ namespace cbl_internal {
         ,_collection(collection)
         ,_docID(docID)
         {
+            auto timing = _collection->timeLock(LockCategory::Observer);
             _c4obs = _collection->useLocked()->observeDocument(docID, [this](C4DocumentObserver*,
                                                                              C4Collection*,
                                                                              slice,
@@ -59,7 +65,7 @@ namespace cbl_internal {
 
         // this is called indirectly by CBLDatabase::sendNotifications
         void call(CBLDocumentChange change) {
-            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            std::lock_guard<OptionalMutex> lock(_mutex);
             auto cb = callback();
             if (cb) {
                 cb(_context, &change);
@@ -88,11 +94,508 @@ CBLCollection::addDocumentListener(slice docID, CBLCollectionDocumentChangeListe
                                    void* _cbl_nullable ctx)
 {
     auto token = new ListenerToken<CBLCollectionDocumentChangeListener>(this, docID, listener, ctx);
+    if (_database->isSingleThreaded())
+        token->setSingleThreaded();
     _docListeners.add(token);
     return token;
 }
 
 Retained<CBLQueryIndex> CBLCollection::getIndex(slice name) {
-    auto index = _c4col.useLocked()->getIndex(name);
+    Retained<C4Index> index;
+    {
+        auto timing = timeLock(LockCategory::Index);
+        index = _c4col.useLocked()->getIndex(name);
+    }
     return index ? new CBLQueryIndex(std::move(index), this) : nullptr;
 }
+
+
+#pragma mark - PATCH:
+
+
+// Applies a JSON Merge Patch (RFC 7396) to a dictionary.
+static void applyMergePatch(MutableDict target, Dict patch) {
+    for (Dict::iterator i(patch); i; ++i) {
+        slice key = i.keyString();
+        Value value = i.value();
+        Dict patchDict = value.asDict();
+        if (value.type() == kFLNull) {
+            target.remove(key);
+        } else if (patchDict && !FLDict_IsBlob(patchDict)) {
+            MutableDict child = target.getMutableDict(key);
+            if (!child) {
+                child = MutableDict::newDict();
+                target[key] = child;
+            }
+            applyMergePatch(child, patchDict);
+        } else {
+            target[key] = value;
+        }
+    }
+}
+
+
+void CBLCollection::patchDocument(slice docID, Dict patch) {
+    useLocked(LockCategory::DocumentWrite, [&](C4Collection* c4col) {
+        C4Database::Transaction t(c4col->getDatabase());
+        
+        // Read the current revision inside the transaction, including a deleted one, so that
+        // the new revision can't conflict:
+        Retained<C4Document> c4doc;
+        try {
+            c4doc = c4col->getDocument(docID, true, kDocGetCurrentRev);
+        } catch (litecore::error& e) {
+            if (e == litecore::error::BadDocID)
+                C4Error::raise(LiteCoreDomain, kC4ErrorBadDocID, "Invalid document ID '%.*s'", FMTSLICE(docID));
+            throw;
+        }
+        
+        Retained<CBLDocument> doc = new CBLDocument(docID, this, c4doc, true);
+        MutableDict props = (c4doc && (c4doc->flags() & kDocDeleted)) ? MutableDict::newDict()
+                                                                      : doc->mutableProperties();
+        applyMergePatch(props, patch);
+        doc->setProperties(props);
+        
+        Retained<C4Document> newDoc = doc->saveRevision(this, c4col, kCBLConcurrencyControlFailOnConflict);
+        if (!newDoc) {
+            C4Error::raise(LiteCoreDomain, kC4ErrorConflict, "Couldn't patch document '%.*s'",
+                           FMTSLICE(docID));
+        }
+        t.commit();
+    });
+}
+
+
+#pragma mark - DOCUMENT CACHE:
+
+
+void CBLCollection::setDocumentCacheCapacity(size_t capacity) {
+    useLocked(LockCategory::Observer, [&](C4Collection* c4col) {
+        if (capacity > 0 && !_docCacheObserver) {
+            _docCacheObserver = c4col->observe([this](C4CollectionObserver*) {
+                this->cachedDocumentsChanged();
+            });
+            _database->documentCacheEnabled(this, true);
+        } else if (capacity == 0 && _docCacheObserver) {
+            _docCacheObserver.reset();
+            _database->documentCacheEnabled(this, false);
+        }
+        _docCache.setCapacity(capacity);
+    });
+}
+
+
+// Called by the database when it closes. The cached documents retain this collection, so they
+// have to be released to break the cycle. Must be called under the lock.
+void CBLCollection::closeDocumentCache() {
+    _docCacheObserver.reset();
+    _docCache.setCapacity(0);
+}
+
+
+RetainedConst<CBLDocument> CBLCollection::getCachedDocument(slice docID) const {
+    if (_docCache.stale())
+        updateDocumentCache();
+
+    uint64_t generation;
+    if (auto doc = _docCache.get(docID, generation); doc)
+        return doc;
+    
+    Retained<C4Document> c4doc = readC4Document(docID);
+    if (!c4doc)
+        return nullptr;
+    Retained<CBLDocument> doc = new CBLDocument(docID, const_cast<CBLCollection*>(this),
+                                                c4doc, false);
+    doc->_shared = true;
+    _docCache.insert(doc, generation);
+    return doc;
+}
+
+
+// Called by the observer, possibly on another thread while it commits a transaction. Reading the
+// changes from here would re-enter the observer, so just mark the cache stale and read them later,
+// either from the notification or from the next cache lookup, whichever comes first.
+void CBLCollection::cachedDocumentsChanged() {
+    _docCache.markStale();
+    Retained<CBLCollection> self = this;
+    _database->notify([self]() {
+        try {
+            self->updateDocumentCache();
+        } catchAndWarnNoReturn()
+    });
+}
+
+
+void CBLCollection::updateDocumentCache() const {
+    auto timing = timeLock(LockCategory::Observer);
+    _c4col.useLocked([&](C4Collection*) {
+        if (!_docCacheObserver || !_docCache.stale())
+            return;
+        _docCache.clearStale();
+        static const uint32_t kMaxChanges = 100;
+        C4CollectionObserver::Change c4changes[kMaxChanges];
+        while (true) {
+            auto result = _docCacheObserver->getChanges(c4changes, kMaxChanges);
+            if (result.numChanges == 0)
+                break;
+            for (uint32_t i = 0; i < result.numChanges; ++i)
+                _docCache.invalidate(c4changes[i].docID);
+        }
+    });
+}
+
+
+#pragma mark - IMPORT:
+
+
+namespace {
+
+    static constexpr unsigned kDefaultImportCommitEvery = 1000;
+    static constexpr size_t kImportReadBufferSize = 64 * 1024;
+
+    // Splits the data supplied by a JSON Lines reader callback into lines.
+    class JSONLinesSplitter {
+    public:
+        explicit JSONLinesSplitter(const CBLCollection::JSONLinesReader &reader)
+        :_reader(reader)
+        ,_readBuffer(kImportReadBufferSize)
+        { }
+
+        // Returns the next line, excluding the line terminator, or false at the end of the data.
+        // The line is only valid until the next call.
+        bool next(slice &outLine) {
+            while (true) {
+                size_t eol = _data.find('\n', _pos);
+                if (eol != std::string::npos) {
+                    outLine = slice(&_data[_pos], eol - _pos);
+                    _pos = eol + 1;
+                    break;
+                }
+                
+                // No complete line in the buffer; discard the consumed data and read more:
+                _data.erase(0, _pos);
+                _pos = 0;
+                if (_eof) {
+                    if (_data.empty())
+                        return false;
+                    outLine = slice(_data);
+                    _pos = _data.size();
+                    break;
+                }
+                
+                int64_t n = _reader(_readBuffer.data(), _readBuffer.size());
+                if (n < 0)
+                    C4Error::raise(LiteCoreDomain, kC4ErrorIOError, "Couldn't read the JSON Lines data");
+                if (n == 0)
+                    _eof = true;
+                else
+                    _data.append(_readBuffer.data(), size_t(n));
+            }
+            
+            if (outLine.size > 0 && outLine[outLine.size - 1] == '\r')
+                outLine.setSize(outLine.size - 1);
+            return true;
+        }
+
+    private:
+        const CBLCollection::JSONLinesReader &_reader;
+        std::vector<char> _readBuffer;
+        std::string _data;
+        size_t _pos {0};
+        bool _eof {false};
+    };
+
+
+    static bool isBlankLine(slice line) {
+        for (size_t i = 0; i < line.size; ++i) {
+            if (!isspace(line[i]))
+                return false;
+        }
+        return true;
+    }
+
+
+    // Must be called under the collection lock inside a transaction. If the document already
+    // exists, its current revision will be overwritten.
+    static void putImportedDocument(C4Collection* c4col,
+                                    slice docID,
+                                    slice body,
+                                    C4RevisionFlags revFlags)
+    {
+        C4DocPutRequest rq = {};
+        rq.body = body;
+        rq.docID = docID;
+        rq.revFlags = revFlags;
+        rq.save = true;
+        C4Error c4err;
+        Retained<C4Document> newDoc = c4col->putDocument(rq, nullptr, &c4err);
+        if (newDoc)
+            return;
+        if (c4err != C4Error{LiteCoreDomain, kC4ErrorConflict})
+            C4Error::raise(c4err);
+        
+        Retained<C4Document> c4doc = c4col->getDocument(docID, true, kDocGetCurrentRev);
+        if (!c4doc || !c4doc->update(body, revFlags))
+            C4Error::raise(LiteCoreDomain, kC4ErrorConflict, "Couldn't import document '%.*s'", FMTSLICE(docID));
+    }
+
+}
+
+
+uint64_t CBLCollection::importJSONLines(const JSONLinesReader &reader,
+                                        const CBLImportJSONLinesOptions* _cbl_nullable options)
+{
+    CBLImportJSONLinesOptions opts = options ? *options : CBLImportJSONLinesOptions{};
+    unsigned commitEvery = opts.commitEvery > 0 ? opts.commitEvery : kDefaultImportCommitEvery;
+    
+    FLKeyPath docIDKeyPath = nullptr;
+    if (opts.docIDKeyPath.buf) {
+        docIDKeyPath = FLKeyPath_New(opts.docIDKeyPath, nullptr);
+        if (!docIDKeyPath) {
+            C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter, "Invalid docIDKeyPath '%.*s'",
+                           FMTSLICE(slice(opts.docIDKeyPath)));
+        }
+    }
+    DEFER {
+        FLKeyPath_Free(docIDKeyPath);
+    };
+    
+    // Lines are copied out of the reader's buffer, then converted to Fleece under the lock, since
+    // they're encoded with the database's shared encoder:
+    struct ImportedLine {
+        uint64_t    lineNumber;
+        alloc_slice json;
+    };
+    std::vector<ImportedLine> batch;
+    batch.reserve(commitEvery);
+    
+    JSONLinesSplitter lines(reader);
+    uint64_t lineNumber = 0, docCount = 0;
+    bool atEnd = false;
+    while (!atEnd) {
+        batch.clear();
+        slice line;
+        while (batch.size() < commitEvery) {
+            if (!lines.next(line)) {
+                atEnd = true;
+                break;
+            }
+            ++lineNumber;
+            if (isBlankLine(line))
+                continue;
+            batch.push_back({lineNumber, alloc_slice(line)});
+        }
+        
+        if (batch.empty())
+            break;
+        
+        // Convert and save the batch in a single transaction:
+        useLocked(LockCategory::DocumentWrite, [&](C4Collection* c4col) {
+            auto c4db = c4col->getDatabase();
+            C4Database::Transaction t(c4db);
+            for (auto &line : batch) {
+                auto n = (unsigned long long)line.lineNumber;
+                SharedEncoder enc(c4db->sharedFleeceEncoder());
+                enc.convertJSON(line.json);
+                FLError flErr;
+                alloc_slice body = enc.finish(&flErr);
+                if (!body)
+                    C4Error::raise(FleeceDomain, flErr, "Line %llu is not valid JSON", n);
+                Doc doc(body, kFLTrusted, c4db->getFleeceSharedKeys());
+                Dict root = doc.root().asDict();
+                if (!root)
+                    C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter,
+                                   "Line %llu is not a JSON object", n);
+                
+                alloc_slice docID;
+                if (docIDKeyPath) {
+                    docID = Value(FLKeyPath_Eval(docIDKeyPath, root)).asString();
+                    if (!docID)
+                        C4Error::raise(LiteCoreDomain, kC4ErrorBadDocID, "Line %llu has no document ID", n);
+                } else {
+                    docID = C4Document::createDocID();
+                }
+                
+                C4RevisionFlags revFlags = C4Blob::dictContainsBlobs(root) ? kRevHasAttachments : 0;
+                putImportedDocument(c4col, docID, body, revFlags);
+            }
+            t.commit();
+        });
+        docCount += batch.size();
+        
+        if (opts.progress && !opts.progress(opts.progressContext, docCount))
+            break;
+    }
+    return docCount;
+}
+
+
+uint64_t CBLCollection::importJSONLinesFile(slice path,
+                                            const CBLImportJSONLinesOptions* _cbl_nullable options)
+{
+    std::ifstream in(path.asString(), std::ios_base::in | std::ios_base::binary);
+    if (!in) {
+        C4Error::raise(LiteCoreDomain, kC4ErrorCantOpenFile, "Couldn't open the file '%.*s'",
+                       FMTSLICE(path));
+    }
+    return importJSONLines([&](void* buffer, size_t bufferSize) -> int64_t {
+        in.read((char*)buffer, std::streamsize(bufferSize));
+        if (in.bad())
+            return -1;
+        return int64_t(in.gcount());
+    }, options);
+}
+
+
+#pragma mark - ENUMERATION:
+
+
+static constexpr unsigned kDefaultEnumeratorBatchSize = 100;
+
+
+Retained<CBLDocumentEnumerator>
+CBLCollection::enumerateDocuments(const CBLDocumentEnumeratorOptions* _cbl_nullable options) const {
+    return new CBLDocumentEnumerator(const_cast<CBLCollection*>(this),
+                                     options ? *options : CBLDocumentEnumeratorOptions{});
+}
+
+
+Retained<CBLChangeBatch> CBLCollection::getChangesSince(uint64_t sinceSequence,
+                                                        unsigned limit,
+                                                        CBLChangesFlags flags) const
+{
+    C4EnumeratorOptions c4opts = {};
+    c4opts.flags = kC4IncludeNonConflicted;
+    if (flags & kCBLChangesIncludeDeleted)
+        c4opts.flags |= kC4IncludeDeleted;
+    
+    Retained<CBLChangeBatch> batch = new CBLChangeBatch(sinceSequence);
+    useLocked(LockCategory::DocumentRead, [&](C4Collection* c4col) {
+        C4DocEnumerator e(c4col, C4SequenceNumber(sinceSequence), c4opts);
+        C4DocumentInfo info;
+        while ((limit == 0 || batch->count() < limit) && e.next()) {
+            if (e.getDocumentInfo(info))
+                batch->add(info);
+        }
+    });
+    return batch;
+}
+
+
+CBLDocumentEnumerator::CBLDocumentEnumerator(CBLCollection* collection,
+                                             const CBLDocumentEnumeratorOptions &options)
+:_collection(collection)
+,_bodies(!options.metadataOnly)
+,_batchSize(options.batchSize > 0 ? options.batchSize : kDefaultEnumeratorBatchSize)
+{
+    C4EnumeratorOptions c4opts = {};
+    c4opts.flags = kC4IncludeNonConflicted;
+    if (options.includeDeleted)
+        c4opts.flags |= kC4IncludeDeleted;
+    if (_bodies)
+        c4opts.flags |= kC4IncludeBodies;
+    
+    _collection->useLocked(LockCategory::DocumentRead, [&](C4Collection* c4col) {
+        if (options.order == kCBLEnumerateBySequence) {
+            _c4enum = std::make_unique<C4DocEnumerator>(c4col, C4SequenceNumber(options.sinceSequence), c4opts);
+        } else {
+            _c4enum = std::make_unique<C4DocEnumerator>(c4col, c4opts);
+            _startDocID = options.startDocID;
+            _endDocID = options.endDocID;
+        }
+    });
+}
+
+
+CBLDocumentEnumerator::~CBLDocumentEnumerator() {
+    try {
+        closeEnumerator();
+    } catchAndWarnNoReturn()
+}
+
+
+bool CBLDocumentEnumerator::next() {
+    if (++_pos < _batch.size())
+        return true;
+    readBatch();
+    _pos = 0;
+    return !_batch.empty();
+}
+
+
+void CBLDocumentEnumerator::readBatch() {
+    _batch.clear();
+    _batch.reserve(_batchSize);
+    // Each time the lock is acquired, at most `_batchSize` documents are examined, including the
+    // ones skipped before `_startDocID`, so other threads can use the collection in between:
+    while (_c4enum && _batch.empty()) {
+        bool atEnd = false;
+        _collection->useLocked(LockCategory::DocumentRead, [&](C4Collection*) {
+            for (unsigned examined = 0; examined < _batchSize; ++examined) {
+                if (!_c4enum->next()) {
+                    atEnd = true;
+                    break;
+                }
+                C4DocumentInfo info = _c4enum->getDocumentInfo();
+                slice docID = info.docID;
+                // C4DocEnumerator has no docID range, but enumerates in docID order, so the range
+                // can be applied here:
+                if (_startDocID) {
+                    if (docID < _startDocID)
+                        continue;
+                    _startDocID = nullslice;    // Every following docID is in range
+                }
+                if (_endDocID && docID > _endDocID) {
+                    atEnd = true;
+                    break;
+                }
+                _batch.push_back({alloc_slice(docID),
+                                  alloc_slice(slice(info.revID)),
+                                  static_cast<uint64_t>(info.sequence),
+                                  info.flags,
+                                  _bodies ? _c4enum->getDocument() : nullptr});
+            }
+        });
+        
+        if (atEnd)
+            closeEnumerator();
+    }
+}
+
+
+void CBLDocumentEnumerator::closeEnumerator() {
+    if (!_c4enum)
+        return;
+    if (_collection->isValid()) {
+        _collection->_c4col.useLocked([&](C4Collection*) {
+            _c4enum.reset();
+        });
+    } else {
+        _c4enum.reset();
+    }
+}
+
+
+const CBLDocumentEnumerator::Entry& CBLDocumentEnumerator::current() const noexcept {
+    static const Entry kNoEntry {};
+    return _pos < _batch.size() ? _batch[_pos] : kNoEntry;
+}
+
+
+FLDict _cbl_nullable CBLDocumentEnumerator::properties() const noexcept {
+    const Entry &entry = current();
+    if (!entry.c4doc)
+        return nullptr;
+    Dict props = ValueFromData(entry.c4doc->getRevisionBody()).asDict();
+    return props ? props : Dict::emptyDict();
+}
+
+
+RetainedConst<CBLDocument> CBLDocumentEnumerator::getDocument() const {
+    const Entry &entry = current();
+    if (!entry.docID)
+        return nullptr;
+    if (entry.c4doc && !(entry.flags & kDocDeleted))
+        return new CBLDocument(entry.docID, _collection, entry.c4doc, false);
+    return _collection->getDocument(entry.docID);
+}
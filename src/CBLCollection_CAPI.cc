@@ -122,6 +122,12 @@ uint64_t CBLCollection_Count(const CBLCollection* collection) noexcept {
     } catchAndWarn()
 }
 
+uint64_t CBLCollection_LastDurableSequence(const CBLCollection* collection) noexcept {
+    try {
+        return collection->lastDurableSequence();
+    } catchAndWarn()
+}
+
 /** Private API */
 uint64_t CBLCollection_LastSequence(const CBLCollection* collection) noexcept {
     try {
@@ -142,6 +148,45 @@ const CBLDocument* CBLCollection_GetDocument(const CBLCollection* collection, FL
     } catchAndBridge(outError)
 }
 
+bool CBLCollection_GetDocuments(const CBLCollection* collection,
+                                FLArray docIDs,
+                                const CBLDocument* _cbl_nullable * outDocs,
+                                CBLError* outError) noexcept
+{
+    try {
+        auto docs = collection->getDocuments(docIDs);
+        for (size_t i = 0; i < docs.size(); ++i)
+            outDocs[i] = std::move(docs[i]).detach();
+        return true;
+    } catchAndBridge(outError)
+}
+
+bool CBLCollection_ReadDocument(const CBLCollection* collection,
+                                FLString docID,
+                                CBLDocumentReadCallback callback,
+                                void* _cbl_nullable context,
+                                CBLError* outError) noexcept
+{
+    try {
+        bool threw = false;
+        bool found = collection->readDocument(docID, [&](const CBLDocumentRevisionInfo &info) {
+            // A callback implemented in C++ may throw; report it as an error instead of unwinding
+            // out of this function:
+            try {
+                callback(context, &info);
+            } catch (...) {
+                cbl_internal::BridgeException(__FUNCTION__, outError);
+                threw = true;
+            }
+        });
+        if (threw)
+            return false;
+        if (!found && outError)
+            outError->code = 0;
+        return found;
+    } catchAndBridge(outError)
+}
+
 CBLDocument* CBLCollection_GetMutableDocument(CBLCollection* collection, FLString docID,
                                               CBLError* outError) noexcept
 {
@@ -189,6 +234,57 @@ bool CBLCollection_SaveDocumentWithConflictHandler(CBLCollection* collection,
     } catchAndBridge(outError)
 }
 
+bool CBLCollection_SaveDocuments(CBLCollection* collection,
+                                 CBLDocument* const * docs,
+                                 size_t count,
+                                 CBLConcurrencyControl concurrency,
+                                 bool* outResults,
+                                 CBLError* outError) noexcept
+{
+    try {
+        CBLDocument::saveAll(collection, docs, count, concurrency, outResults);
+        return true;
+    } catchAndBridge(outError)
+}
+
+bool CBLCollection_SaveDocumentAsync(CBLCollection* collection,
+                                     CBLDocument* doc,
+                                     CBLConcurrencyControl concurrency,
+                                     CBLSaveCompletionCallback completion,
+                                     void* context,
+                                     CBLError* outError) noexcept
+{
+    try {
+        collection->saveDocumentAsync(doc, concurrency, completion, context);
+        return true;
+    } catchAndBridge(outError)
+}
+
+bool CBLCollection_PatchDocument(CBLCollection* collection,
+                                 FLString docID,
+                                 FLDict patch,
+                                 CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        collection->patchDocument(docID, patch);
+        return true;
+    } catchAndBridge(outError)
+}
+
+bool CBLCollection_PatchDocumentWithJSON(CBLCollection* collection,
+                                         FLString docID,
+                                         FLString jsonPatch,
+                                         CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        Doc patch = Doc::fromJSON(jsonPatch);
+        if (!patch.root().asDict())
+            C4Error::raise(FleeceDomain, kFLJSONError, "Invalid JSON merge patch");
+        collection->patchDocument(docID, patch.root().asDict());
+        return true;
+    } catchAndBridge(outError)
+}
+
 bool CBLCollection_DeleteDocument(CBLCollection *collection,
                                   const CBLDocument* doc,
                                   CBLError* outError) noexcept
@@ -245,6 +341,28 @@ bool CBLCollection_PurgeDocumentByID(CBLCollection* collection,
     } catchAndBridge(outError)
 }
 
+bool CBLCollection_DeleteDocuments(CBLCollection* collection,
+                                   FLArray docIDs,
+                                   bool* _cbl_nullable outResults,
+                                   CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        collection->deleteDocuments(docIDs, outResults);
+        return true;
+    } catchAndBridge(outError)
+}
+
+bool CBLCollection_PurgeDocuments(CBLCollection* collection,
+                                  FLArray docIDs,
+                                  bool* _cbl_nullable outResults,
+                                  CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        collection->purgeDocuments(docIDs, outResults);
+        return true;
+    } catchAndBridge(outError)
+}
+
 CBLTimestamp CBLCollection_GetDocumentExpiration(CBLCollection* collection,
                                                  FLSlice docID,
                                                  CBLError* outError) noexcept
@@ -265,6 +383,131 @@ bool CBLCollection_SetDocumentExpiration(CBLCollection* collection,
     } catchAndBridge(outError)
 }
 
+#pragma mark - DOCUMENT CACHE:
+
+bool CBLCollection_SetDocumentCacheCapacity(CBLCollection* collection,
+                                            size_t capacity,
+                                            CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        collection->setDocumentCacheCapacity(capacity);
+        return true;
+    } catchAndBridge(outError)
+}
+
+CBLDocumentCacheStats CBLCollection_GetDocumentCacheStats(const CBLCollection* collection) noexcept {
+    return collection->documentCacheStats();
+}
+
+#pragma mark - IMPORT:
+
+bool CBLCollection_ImportJSONLines(CBLCollection* collection,
+                                   CBLJSONLinesReader reader,
+                                   void* _cbl_nullable readerContext,
+                                   const CBLImportJSONLinesOptions* _cbl_nullable options,
+                                   uint64_t* _cbl_nullable outDocCount,
+                                   CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        auto count = collection->importJSONLines([&](void* buffer, size_t bufferSize) {
+            return reader(readerContext, buffer, bufferSize);
+        }, options);
+        if (outDocCount)
+            *outDocCount = count;
+        return true;
+    } catchAndBridge(outError)
+}
+
+bool CBLCollection_ImportJSONLinesFile(CBLCollection* collection,
+                                       FLString path,
+                                       const CBLImportJSONLinesOptions* _cbl_nullable options,
+                                       uint64_t* _cbl_nullable outDocCount,
+                                       CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        auto count = collection->importJSONLinesFile(path, options);
+        if (outDocCount)
+            *outDocCount = count;
+        return true;
+    } catchAndBridge(outError)
+}
+
+#pragma mark - ENUMERATION:
+
+CBLDocumentEnumerator* CBLCollection_EnumerateDocuments(const CBLCollection* collection,
+                                                        const CBLDocumentEnumeratorOptions* _cbl_nullable options,
+                                                        CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        return collection->enumerateDocuments(options).detach();
+    } catchAndBridge(outError)
+}
+
+bool CBLDocumentEnumerator_Next(CBLDocumentEnumerator* e, CBLError* _cbl_nullable outError) noexcept {
+    try {
+        bool hasNext = e->next();
+        if (!hasNext && outError)
+            outError->code = 0;
+        return hasNext;
+    } catchAndBridge(outError)
+}
+
+FLString CBLDocumentEnumerator_DocumentID(const CBLDocumentEnumerator* e) noexcept {
+    return e->docID();
+}
+
+FLString CBLDocumentEnumerator_RevisionID(const CBLDocumentEnumerator* e) noexcept {
+    return e->revisionID();
+}
+
+uint64_t CBLDocumentEnumerator_Sequence(const CBLDocumentEnumerator* e) noexcept {
+    return e->sequence();
+}
+
+bool CBLDocumentEnumerator_IsDeleted(const CBLDocumentEnumerator* e) noexcept {
+    return e->isDeleted();
+}
+
+FLDict CBLDocumentEnumerator_Properties(const CBLDocumentEnumerator* e) noexcept {
+    return e->properties();
+}
+
+const CBLDocument* CBLDocumentEnumerator_GetDocument(const CBLDocumentEnumerator* e,
+                                                     CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        auto doc = e->getDocument().detach();
+        if (!doc && outError)
+            outError->code = 0;
+        return doc;
+    } catchAndBridge(outError)
+}
+
+#pragma mark - CHANGES:
+
+CBLChangeBatch* CBLCollection_GetChangesSince(const CBLCollection* collection,
+                                              uint64_t sinceSequence,
+                                              unsigned limit,
+                                              CBLChangesFlags flags,
+                                              CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        return collection->getChangesSince(sinceSequence, limit, flags).detach();
+    } catchAndBridge(outError)
+}
+
+size_t CBLChangeBatch_Count(const CBLChangeBatch* batch) noexcept {
+    return batch->count();
+}
+
+const CBLChangedDocument* CBLChangeBatch_Get(const CBLChangeBatch* batch, size_t index) noexcept {
+    return &batch->get(index);
+}
+
+uint64_t CBLChangeBatch_LastSequence(const CBLChangeBatch* batch) noexcept {
+    return batch->lastSequence();
+}
+
 #pragma mark - INDEXES:
 
 bool CBLCollection_CreateValueIndex(CBLCollection *collection,
@@ -24,6 +24,10 @@
 #include "CBLScope_Internal.hh"
 #include "CBLVectorIndexConfig.hh"
 #include "Defer.hh"
+#include "DocumentCache.hh"
+#include <deque>
+#include <functional>
+#include <vector>
 
 CBL_ASSUME_NONNULL_BEGIN
 
@@ -49,6 +53,11 @@ public:
     }
     
     ~CBLCollection() {
+        if (_docCacheObserver) {
+            // The cache was enabled but is empty, else its documents would have retained this:
+            std::lock_guard<OptionalMutex> lock(_database->c4db()->mutex());
+            _database->documentCacheEnabled(this, false);
+        }
         LOCK(_adoptMutex);
         if (!_adopted) {
             release(_database);
@@ -62,8 +71,18 @@ public:
     slice fullName() const noexcept             {return _fullName;}
     C4CollectionSpec spec() const noexcept      {return {_name, _scope->name()};}
     bool isValid() const noexcept               {return _c4col.isValid();}
-    uint64_t count() const                      {return _c4col.useLocked()->getDocumentCount();}
-    uint64_t lastSequence() const               {return static_cast<uint64_t>(_c4col.useLocked()->getLastSequence());}
+    uint64_t count() const {
+        uint64_t count = 0;
+        useForReading([&](C4Collection* c4col) { count = c4col->getDocumentCount(); });
+        return count;
+    }
+    uint64_t lastSequence() const {
+        auto timing = timeLock(LockCategory::DocumentRead);
+        return static_cast<uint64_t>(_c4col.useLocked()->getLastSequence());
+    }
+    uint64_t lastDurableSequence() const {
+        return _database->lastDurableSequence(spec(), lastSequence());
+    }
     CBLDatabase* database() const               {return _database; }
     
 #pragma mark - OPERATORS:
@@ -80,6 +99,9 @@ public:
 #pragma mark - DOCUMENTS:
     
     RetainedConst<CBLDocument> getDocument(slice docID, bool allRevisions =false) const {
+        // Inside a transaction, skip the cache: its observer only hears of changes on commit.
+        if (!allRevisions && _docCache.enabled() && _database->_transactionDepth == 0)
+            return getCachedDocument(docID);
         return getDocument(docID, false, allRevisions);
     }
 
@@ -87,13 +109,75 @@ public:
         return getDocument(docID, true, true);
     }
     
+    /** Reads the documents with the given IDs under a single acquisition of the collection lock.
+        The result has one entry per docID, which is null if the document doesn't exist. */
+    std::vector<Retained<CBLDocument>> getDocuments(Array docIDs) const {
+        checkDocIDs(docIDs);
+        uint32_t count = docIDs.count();
+        
+        std::vector<Retained<C4Document>> c4docs(count);
+        {
+            auto timing = timeLock(LockCategory::DocumentRead);
+            auto c4col = _c4col.useLocked();
+            for (uint32_t i = 0; i < count; ++i)
+                c4docs[i] = getC4Document(c4col.get(), docIDs[i].asString(), false);
+        }
+        
+        std::vector<Retained<CBLDocument>> docs(count);
+        for (uint32_t i = 0; i < count; ++i) {
+            if (c4docs[i])
+                docs[i] = new CBLDocument(docIDs[i].asString(), const_cast<CBLCollection*>(this), c4docs[i], false);
+        }
+        return docs;
+    }
+    
+    /** Calls `callback` with the current revision of a document, without creating a CBLDocument.
+        The C4Document keeps the body alive while the callback runs, but the collection is not
+        locked. Returns false if the document doesn't exist. */
+    template <class Callback>
+    bool readDocument(slice docID, Callback callback) const {
+        // A C4Document read from a reader belongs to it, so the reader stays in use until the
+        // callback returns and the C4Document is released:
+        bool found = false;
+        bool usedReader = _database->useReader([&](cbl_internal::ReaderPool::Reader &reader) {
+            C4Collection* c4col = reader.db->getCollection(spec());
+            if (!c4col)
+                return false;   // Created after the reader was opened
+            Retained<C4Document> c4doc = getC4Document(c4col, docID, false);
+            if (c4doc) {
+                found = true;
+                callWithRevision(c4doc, callback);
+            }
+            return true;
+        });
+        if (usedReader)
+            return found;
+        
+        Retained<C4Document> c4doc = readC4Document(docID);
+        if (!c4doc)
+            return false;
+        callWithRevision(c4doc, callback);
+        return true;
+    }
+    
+    /** Applies a JSON Merge Patch to the current revision of a document, creating it if needed,
+        in a single transaction. */
+    void patchDocument(slice docID, Dict patch);
+    
     bool deleteDocument(const CBLDocument *doc, CBLConcurrencyControl concurrency) {
         CBLDocument::SaveOptions opt(concurrency);
         opt.deleting = true;
+        if (doc->_shared) {
+            // Every reader of a cached document gets the same instance, so delete a copy of it
+            // rather than changing the instance under them:
+            Retained<CBLDocument> copy = new CBLDocument(doc);
+            return copy->save(this, opt);
+        }
         return const_cast<CBLDocument*>(doc)->save(this, opt);
     }
     
     bool deleteDocument(slice docID) {
+        auto timing = timeLock(LockCategory::DocumentWrite);
         auto c4col = _c4col.useLocked();
         C4Database::Transaction t(c4col->getDatabase());
         Retained<C4Document> c4doc = c4col->getDocument(docID, false, kDocGetCurrentRev);
@@ -106,9 +190,62 @@ public:
     }
     
     bool purgeDocument(slice docID) {
+        auto timing = timeLock(LockCategory::DocumentWrite);
         return _c4col.useLocked()->purgeDocument(docID);
     }
     
+    /** Queues a save to be committed by the database's write queue. */
+    void saveDocumentAsync(CBLDocument* doc,
+                           CBLConcurrencyControl concurrency,
+                           CBLSaveCompletionCallback _cbl_nullable completion,
+                           void* _cbl_nullable context)
+    {
+        if (!isValid())
+            C4Error::raise(LiteCoreDomain, kC4ErrorNotOpen, "Invalid collection: either deleted or db closed");
+        _database->writeQueue()->enqueue(this, doc, concurrency, completion, context);
+    }
+    
+    /** Deletes the documents with the given IDs in a single transaction. If outResults is given,
+        each entry is set to true if the document was deleted, or false if it doesn't exist. */
+    void deleteDocuments(Array docIDs, bool* _cbl_nullable outResults) {
+        checkDocIDs(docIDs);
+        uint32_t count = docIDs.count();
+        std::vector<bool> results(count);
+        {
+            auto timing = timeLock(LockCategory::DocumentWrite);
+            _c4col.useLocked([&](C4Collection* c4col) {
+                C4Database::Transaction t(c4col->getDatabase());
+                for (uint32_t i = 0; i < count; ++i) {
+                    Retained<C4Document> c4doc = getC4Document(c4col, docIDs[i].asString(), false);
+                    if (c4doc)
+                        results[i] = (c4doc->update(fleece::nullslice, kRevDeleted) != nullptr);
+                }
+                t.commit();
+            });
+        }
+        if (outResults)
+            std::copy(results.begin(), results.end(), outResults);
+    }
+    
+    /** Purges the documents with the given IDs in a single transaction. If outResults is given,
+        each entry is set to true if the document was purged, or false if it doesn't exist. */
+    void purgeDocuments(Array docIDs, bool* _cbl_nullable outResults) {
+        checkDocIDs(docIDs);
+        uint32_t count = docIDs.count();
+        std::vector<bool> results(count);
+        {
+            auto timing = timeLock(LockCategory::DocumentWrite);
+            _c4col.useLocked([&](C4Collection* c4col) {
+                C4Database::Transaction t(c4col->getDatabase());
+                for (uint32_t i = 0; i < count; ++i)
+                    results[i] = c4col->purgeDocument(docIDs[i].asString());
+                t.commit();
+            });
+        }
+        if (outResults)
+            std::copy(results.begin(), results.end(), outResults);
+    }
+    
     CBLTimestamp getDocumentExpiration(slice docID) {
         return static_cast<CBLTimestamp>(_c4col.useLocked()->getExpiration(docID));
     }
@@ -119,6 +256,29 @@ public:
         }
     }
     
+#pragma mark - DOCUMENT CACHE:
+    
+    void setDocumentCacheCapacity(size_t capacity);
+    
+    CBLDocumentCacheStats documentCacheStats() const    {return _docCache.stats();}
+    
+#pragma mark - IMPORT:
+    
+    using JSONLinesReader = std::function<int64_t(void* buffer, size_t bufferSize)>;
+    
+    /** Imports JSON Lines data, saving the documents in batches of `options.commitEvery`.
+        Returns the number of imported documents. */
+    uint64_t importJSONLines(const JSONLinesReader &reader,
+                             const CBLImportJSONLinesOptions* _cbl_nullable options);
+    
+    uint64_t importJSONLinesFile(slice path, const CBLImportJSONLinesOptions* _cbl_nullable options);
+    
+#pragma mark - ENUMERATION:
+    
+    Retained<CBLDocumentEnumerator> enumerateDocuments(const CBLDocumentEnumeratorOptions* _cbl_nullable options) const;
+    
+    Retained<CBLChangeBatch> getChangesSince(uint64_t sinceSequence, unsigned limit, CBLChangesFlags flags) const;
+    
 #pragma mark - INDEXES:
     
     void createValueIndex(slice name, CBLValueIndexConfiguration config) {
@@ -130,9 +290,11 @@ public:
             options.where = (const char*)whereAlloc.buf;
         }
         
+        auto timing = timeLock(LockCategory::Index);
         _c4col.useLocked()->createIndex(name, config.expressions,
                                         (C4QueryLanguage)config.expressionLanguage,
                                         kC4ValueIndex, &options);
+        _database->clearQueryCache();
     }
     
     void createFullTextIndex(slice name, CBLFullTextIndexConfiguration config) {
@@ -152,9 +314,11 @@ public:
             options.where = (const char*)whereAlloc.buf;
         }
         
+        auto timing = timeLock(LockCategory::Index);
         _c4col.useLocked()->createIndex(name, config.expressions,
                                         (C4QueryLanguage)config.expressionLanguage,
                                         kC4FullTextIndex, &options);
+        _database->clearQueryCache();
     }
     
     void createArrayIndex(slice name, CBLArrayIndexConfiguration config) {
@@ -169,9 +333,11 @@ public:
         }
         
         config.expressions = exprs;
+        auto timing = timeLock(LockCategory::Index);
         _c4col.useLocked()->createIndex(name, exprs,
                                         (C4QueryLanguage)config.expressionLanguage,
                                         kC4ArrayIndex, &options);
+        _database->clearQueryCache();
     }
     
 #ifdef COUCHBASE_ENTERPRISE
@@ -229,23 +395,28 @@ public:
         C4IndexOptions options {};
         options.vector = vector;
         
+        auto timing = timeLock(LockCategory::Index);
         _c4col.useLocked()->createIndex(name, config.expression,
                                         (C4QueryLanguage)config.expressionLanguage,
                                         kC4VectorIndex, &options);
+        _database->clearQueryCache();
     }
     
     bool isIndexTrained(slice name) const {
+        auto timing = timeLock(LockCategory::Index);
         return _c4col.useLocked()->isIndexTrained(name);
     }
 
 #endif
     
     void deleteIndex(slice name) {
+        auto timing = timeLock(LockCategory::Index);
         _c4col.useLocked()->deleteIndex(name);
+        _database->clearQueryCache();
     }
 
     fleece::MutableArray indexNames() {
-        Doc doc(_c4col.useLocked()->getIndexesInfo());
+        Doc doc(getIndexesInfo());
         auto indexes = fleece::MutableArray::newArray();
         for (Array::iterator i(doc.root().asArray()); i; ++i) {
             Dict info = i.value().asDict();
@@ -257,7 +428,7 @@ public:
     Retained<CBLQueryIndex> getIndex(slice name);
     
     fleece::MutableArray indexesInfo() const {
-        Doc doc(_c4col.useLocked()->getIndexesInfo());
+        Doc doc(getIndexesInfo());
         return doc.root().asArray().mutableCopy();
     }
     
@@ -289,6 +460,7 @@ protected:
     
     friend struct CBLDatabase;
     friend struct CBLDocument;
+    friend struct CBLDocumentEnumerator;
     friend struct cbl_internal::ListenerToken<CBLCollectionDocumentChangeListener>;
     friend struct CBLURLEndpointListener;
     
@@ -304,19 +476,107 @@ protected:
         }
     }
     
+    /** Calls `callback(C4Collection*)` to read from the collection: if the database has an idle
+        reader, with the reader's C4Collection and without locking, else under the lock. */
+    template <class LAMBDA>
+    void useForReading(LAMBDA callback) const {
+        bool done = _database->useReader([&](cbl_internal::ReaderPool::Reader &reader) {
+            C4Collection* c4col = reader.db->getCollection(spec());
+            if (!c4col)
+                return false;   // Created after the reader was opened
+            callback(c4col);
+            return true;
+        });
+        if (!done) {
+            auto timing = timeLock(LockCategory::DocumentRead);
+            callback(_c4col.useLocked().get());
+        }
+    }
+    
+    /** Gets the current revision of a document from the primary C4Database. A CBLDocument's
+        C4Document can't come from a reader: it keeps using its C4Database, e.g. to look up
+        revision IDs or to save a mutable copy, after the reader is released or even closed. */
+    Retained<C4Document> readC4Document(slice docID) const {
+        auto timing = timeLock(LockCategory::DocumentRead);
+        return getC4Document(_c4col.useLocked().get(), docID, false);
+    }
+    
+    /** Records the time spent waiting for and holding the lock until the end of the scope, if the
+        database's lock stats are enabled. */
+    auto timeLock(LockCategory category) const  { return _database->timeLock(category); }
+    
+    alloc_slice getIndexesInfo() const {
+        auto timing = timeLock(LockCategory::Index);
+        return _c4col.useLocked()->getIndexesInfo();
+    }
+    
     auto useLocked()                        { return _c4col.useLocked(); }
     template <class LAMBDA>
     void useLocked(LAMBDA callback)         { _c4col.useLocked(callback); }
     template <class RESULT, class LAMBDA>
     RESULT useLocked(LAMBDA callback)       { return _c4col.useLocked<RESULT>(callback); }
     
+    // Variants that record lock stats in the given category:
+    template <class LAMBDA>
+    void useLocked(LockCategory category, LAMBDA callback) {
+        auto timing = timeLock(category);
+        _c4col.useLocked(callback);
+    }
+    template <class RESULT, class LAMBDA>
+    RESULT useLocked(LockCategory category, LAMBDA callback) {
+        auto timing = timeLock(category);
+        return _c4col.useLocked<RESULT>(callback);
+    }
+    
 private:
     
     Retained<CBLDocument> getDocument(slice docID, bool isMutable, bool allRevisions) const {
+        Retained<C4Document> c4doc;
+        {
+            auto timing = timeLock(LockCategory::DocumentRead);
+            c4doc = getC4Document(_c4col.useLocked().get(), docID, allRevisions);
+        }
+        if (!c4doc)
+            return nullptr;
+        return new CBLDocument(docID, const_cast<CBLCollection*>(this), c4doc, isMutable);
+    }
+    
+    RetainedConst<CBLDocument> getCachedDocument(slice docID) const;
+    
+    // Calls a `readDocument` callback with the document's current revision:
+    template <class Callback>
+    void callWithRevision(C4Document* c4doc, Callback &callback) const {
+        const C4Revision &rev = c4doc->selectedRev();
+        CBLDocumentRevisionInfo info = {};
+        info.docID = c4doc->docID();
+        info.revisionID = rev.revID;
+        info.sequence = static_cast<uint64_t>(rev.sequence);
+        info.timestamp = C4Document::getRevIDTimestamp(rev.revID);
+        info.properties = ValueFromData(c4doc->getRevisionBody()).asDict();
+        if (!info.properties)
+            info.properties = Dict::emptyDict();
+        ReadDocumentBlobs blobs(_database, c4doc);
+        callback(info);
+    }
+    
+    static void checkDocIDs(Array docIDs) {
+        for (Array::iterator i(docIDs); i; ++i) {
+            if (!i.value().asString())
+                C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter, "docIDs must only contain strings");
+        }
+    }
+    
+    void cachedDocumentsChanged();
+    void updateDocumentCache() const;
+    void closeDocumentCache();
+    
+    // Must be called under the collection lock. Returns null if the doc doesn't exist,
+    // has an invalid ID, or is deleted (unless allRevisions is true.)
+    static Retained<C4Document> getC4Document(C4Collection* c4col, slice docID, bool allRevisions) {
         C4DocContentLevel content = (allRevisions ? kDocGetAll : kDocGetCurrentRev);
         Retained<C4Document> c4doc = nullptr;
         try {
-            c4doc = _c4col.useLocked()->getDocument(docID, true, content);
+            c4doc = c4col->getDocument(docID, true, content);
         } catch (litecore::error& e) {
             if (e == litecore::error::BadDocID) {
                 CBL_Log(kCBLLogDomainDatabase, kCBLLogWarning,
@@ -327,17 +587,21 @@ private:
         }
         if (!c4doc || (!allRevisions && (c4doc->flags() & kDocDeleted)))
             return nullptr;
-        return new CBLDocument(docID, const_cast<CBLCollection*>(this), c4doc, isMutable);
+        return c4doc;
     }
     
 #pragma mark - LISTENERS:
     
     Retained<CBLListenerToken> addListener(fleece::function_ref<Retained<CBLListenerToken>()> cb) {
         Retained<CBLListenerToken> token = cb();
-        if (!_observer)
+        if (_database->isSingleThreaded())
+            token->setSingleThreaded();
+        if (!_observer) {
+            auto timing = timeLock(LockCategory::Observer);
             _observer = _c4col.useLocked()->observe([this](C4CollectionObserver*) {
                 this->collectionChanged();
             });
+        }
         return token;
     }
     
@@ -374,7 +638,7 @@ private:
         @Note  Subclass for setting up the sentry for throwing NotOpen exception when the c4collection becomes invalid.
         @Note  Retain the shared_ptr of the CBLDatabase's c4db access lock to maintain the life time of the mutex
      */
-    class C4CollectionAccessLock: public litecore::shared_access_lock<Retained<C4Collection>> {
+    class C4CollectionAccessLock: public litecore::shared_access_lock<Retained<C4Collection>, OptionalMutex> {
     public:
         C4CollectionAccessLock(C4Collection* c4col, CBLDatabase* database)
         :shared_access_lock(std::move(c4col), *database->c4db())
@@ -416,6 +680,86 @@ private:
     std::unique_ptr<C4CollectionObserver>                   _observer;
     Listeners<CBLCollectionChangeListener>                  _listeners;
     Listeners<CBLCollectionDocumentChangeListener>          _docListeners;
+    
+    mutable cbl_internal::DocumentCache                     _docCache;              // Its docs retain this
+    std::unique_ptr<C4CollectionObserver>                   _docCacheObserver;      // Under the lock
+};
+
+
+struct CBLDocumentEnumerator final : public CBLRefCounted {
+public:
+    CBLDocumentEnumerator(CBLCollection* collection, const CBLDocumentEnumeratorOptions &options);
+    
+    ~CBLDocumentEnumerator();
+    
+    bool next();
+    
+    slice docID() const noexcept                {return current().docID;}
+    slice revisionID() const noexcept           {return current().revID;}
+    uint64_t sequence() const noexcept          {return current().sequence;}
+    bool isDeleted() const noexcept             {return (current().flags & kDocDeleted) != 0;}
+    FLDict _cbl_nullable properties() const noexcept;
+    
+    RetainedConst<CBLDocument> getDocument() const;
+    
+private:
+    struct Entry {
+        alloc_slice                     docID;
+        alloc_slice                     revID;
+        uint64_t                        sequence {0};
+        C4DocumentFlags                 flags {0};
+        Retained<C4Document>            c4doc;      // Only set when reading bodies
+    };
+    
+    const Entry& current() const noexcept;
+    
+    // Reads the next batch of entries under the collection lock.
+    void readBatch();
+    
+    void closeEnumerator();
+    
+    Retained<CBLCollection>             _collection;
+    std::unique_ptr<C4DocEnumerator>    _c4enum;        // Only accessed under the collection lock
+    alloc_slice                         _startDocID;
+    alloc_slice                         _endDocID;
+    bool                                _bodies;
+    unsigned                            _batchSize;
+    
+    std::vector<Entry>                  _batch;
+    size_t                              _pos {0};
+};
+
+
+struct CBLChangeBatch final : public CBLRefCounted {
+public:
+    explicit CBLChangeBatch(uint64_t sinceSequence)
+    :_lastSequence(sinceSequence)
+    { }
+    
+    size_t count() const noexcept                   {return _changes.size();}
+    const CBLChangedDocument& get(size_t index) const noexcept {
+        precondition(index < _changes.size());
+        return _changes[index];
+    }
+    uint64_t lastSequence() const noexcept          {return _lastSequence;}
+    
+    void add(const C4DocumentInfo &info) {
+        _strings.emplace_back(slice(info.docID));
+        slice docID = _strings.back();
+        _strings.emplace_back(slice(info.revID));
+        slice revID = _strings.back();
+        _changes.push_back({docID,
+                            revID,
+                            static_cast<uint64_t>(info.sequence),
+                            (info.flags & kDocDeleted) != 0,
+                            info.bodySize});
+        _lastSequence = static_cast<uint64_t>(info.sequence);
+    }
+    
+private:
+    std::deque<alloc_slice>             _strings;       // Owns the changes' docIDs and revIDs
+    std::vector<CBLChangedDocument>     _changes;
+    uint64_t                            _lastSequence;
 };
 
 CBL_ASSUME_NONNULL_END
@@ -82,17 +82,27 @@ bool CBLEncryptionKey_FromPasswordOld(CBLEncryptionKey *key, FLString password)
 #pragma mark - CONSTRUCTORS:
 
 
-CBLDatabase::CBLDatabase(C4Database* _cbl_nonnull db, slice name_, slice dir_)
+CBLDatabase::CBLDatabase(C4Database* _cbl_nonnull db, slice name_, slice dir_, bool singleThreaded)
 :_dir(dir_)
 ,_name(name_)
+,_singleThreaded(singleThreaded)
 ,_notificationQueue(this)
+,_durabilitySyncer(this)
 {
     _c4db = std::make_shared<C4DatabaseAccessLock>(db);
+    if (singleThreaded)
+        _c4db->setSingleThreaded();     // Also disables the collections' locks, which share it
+    _writeQueue = new WriteQueue(this);
+    _queryRunner = new QueryRunner();
 }
 
 
 CBLDatabase::~CBLDatabase() {
+    _writeQueue->stop();
+    _queryRunner->stop();
+    _durabilitySyncer.stop();
     _c4db->useLockedIgnoredWhenClosed([&](Retained<C4Database> &c4db) {
+        _queryCache.clear();
         _closed();
     });
 }
@@ -103,9 +113,14 @@ CBLDatabase::~CBLDatabase() {
 
 void CBLDatabase::close() {
     stopActiveService();
+    _writeQueue->stop();    // Commits the pending asynchronous saves
+    _queryRunner->stop();   // Cancels the pending asynchronous queries
+    _durabilitySyncer.stop();
+    _readerPool.close();
     
     try {
         auto db = _c4db->useLocked();
+        _queryCache.clear();
         db->close();
         _closed();
     } catch (litecore::error& e) {
@@ -119,8 +134,13 @@ void CBLDatabase::close() {
 
 void CBLDatabase::closeAndDelete() {
     stopActiveService();
+    _writeQueue->stop();
+    _queryRunner->stop();
+    _durabilitySyncer.stop();
+    _readerPool.close();
     
     auto db = _c4db->useLocked();
+    _queryCache.clear();
     db->closeAndDeleteFile();
     _closed();
 }
@@ -128,11 +148,129 @@ void CBLDatabase::closeAndDelete() {
 
 /** Must called under _c4db lock. */
 void CBLDatabase::_closed() {
+    // Release the cached documents, which may be the last references to their collections:
+    auto collections = std::move(_documentCacheCollections);
+    _documentCacheCollections.clear();
+    for (CBLCollection* collection : collections) {
+        Retained<CBLCollection> retained = collection;
+        collection->closeDocumentCache();
+    }
+    
     // Close the access lock:
     _c4db->close();
 }
 
 
+#pragma mark - TRANSACTIONS:
+
+
+static string collectionKey(C4CollectionSpec spec) {
+    return string(slice(spec.scope)) + "." + string(slice(spec.name));
+}
+
+
+void CBLDatabase::beginTransaction() {
+    auto timing = timeLock(LockCategory::Transaction);
+    auto db = _c4db->useLocked();
+    db->beginTransaction();
+    ++_transactionDepth;    // Under the lock, since the write queue checks it under the lock
+}
+
+
+void CBLDatabase::endTransaction(bool commit, CBLDurability durability) {
+    // A single-threaded database has no syncer thread, so it syncs deferred transactions at once:
+    if (durability == kCBLDurabilityDeferred && _singleThreaded)
+        durability = kCBLDurabilityImmediate;
+    
+    auto timing = timeLock(LockCategory::Transaction);
+    auto db = _c4db->useLocked();
+    if (_transactionDepth == 0)
+        C4Error::raise(LiteCoreDomain, kC4ErrorNotInTransaction, "No transaction is open");
+    try {
+        db->endTransaction(commit);
+    } catch (...) {
+        // LiteCore ends the transaction even if committing it fails:
+        if (--_transactionDepth == 0) {
+            _pendingDurability = kCBLDurabilityNone;
+            _writeQueue->transactionEnded();
+        }
+        throw;
+    }
+    _pendingDurability = max(_pendingDurability, durability);
+    if (--_transactionDepth > 0)
+        return;     // Only the outermost transaction commits to disk
+    _writeQueue->transactionEnded();
+    
+    // Apply the strongest durability requested by any of the nested transactions:
+    durability = commit ? _pendingDurability : kCBLDurabilityNone;
+    _pendingDurability = kCBLDurabilityNone;
+    switch (durability) {
+        case kCBLDurabilityImmediate:
+            if (!syncToDisk()) {
+                if (!_singleThreaded)
+                    _durabilitySyncer.schedule();   // Try again later
+                C4Error::raise(LiteCoreDomain, kC4ErrorBusy,
+                               "The transaction was committed, but couldn't be synced to disk");
+            }
+            break;
+        case kCBLDurabilityDeferred:
+            _durabilitySyncer.schedule();
+            break;
+        default:
+            break;
+    }
+}
+
+
+bool CBLDatabase::syncToDisk() {
+    auto db = _c4db->useLocked();
+    if (db->isInTransaction())
+        return false;
+    
+    // In WAL mode, a checkpoint syncs the WAL, and with it every committed transaction, to disk.
+    // Its result row is (busy, log, checkpointed): it's only complete if another connection
+    // didn't block it, and it copied every frame in the WAL to the database file:
+    alloc_slice result = db->rawQuery("PRAGMA wal_checkpoint(FULL)"_sl);
+    Array row = ValueFromData(result).asArray()[0].asArray();
+    int64_t busy = row[0].asInt(), logFrames = row[1].asInt(), checkpointed = row[2].asInt();
+    if (!row || busy != 0 || checkpointed != logFrames) {
+        CBL_Log(kCBLLogDomainDatabase, kCBLLogInfo,
+                "WAL checkpoint incomplete (busy=%lld, log=%lld, checkpointed=%lld)",
+                (long long)busy, (long long)logFrames, (long long)checkpointed);
+        return false;
+    }
+    
+    // Record the collections' sequences, which are now durable:
+    vector<pair<alloc_slice, alloc_slice>> specs;   // (name, scope)
+    db->forEachScope([&](slice scope) {
+        db->forEachCollection(scope, [&](C4CollectionSpec spec) {
+            specs.emplace_back(spec.name, spec.scope);
+        });
+    });
+    unordered_map<string, uint64_t> sequences;
+    for (auto &[name, scope] : specs) {
+        C4CollectionSpec spec = {name, scope};
+        if (C4Collection* c4col = db->getCollection(spec))
+            sequences[collectionKey(spec)] = static_cast<uint64_t>(c4col->getLastSequence());
+    }
+    
+    LOCK(_durableMutex);
+    _durableSequences = std::move(sequences);
+    return true;
+}
+
+
+uint64_t CBLDatabase::lastDurableSequence(C4CollectionSpec spec, uint64_t lastSequence) const {
+    if (_c4db->useLocked()->getConfiguration().flags & kC4DB_DiskSyncFull)
+        return lastSequence;    // Every commit is synced to disk
+    LOCK(_durableMutex);
+    auto i = _durableSequences.find(collectionKey(spec));
+    if (i == _durableSequences.end())
+        return 0;
+    return min(i->second, lastSequence);   // In case the collection has been recreated
+}
+
+
 #pragma mark - SCOPES:
 
 
@@ -190,6 +328,7 @@ bool CBLDatabase::deleteCollection(slice collectionName, slice scopeName) {
     
     auto spec = C4Database::CollectionSpec(collectionName, scopeName);
     c4db->deleteCollection(spec);
+    _queryCache.clear();
     return true;
 }
 
@@ -225,10 +364,76 @@ Retained<CBLQuery> CBLDatabase::createQuery(CBLQueryLanguage language,
         json = convertJSON5(queryString); // allow JSON5 as a convenience
         queryString = json;
     }
-    auto c4query = _c4db->useLocked()->newQuery((C4QueryLanguage)language, queryString, outErrPos);
-    if (!c4query)
+    auto c4lang = (C4QueryLanguage)language;
+    auto timing = timeLock(LockCategory::Query);
+    auto c4db = _c4db->useLocked();
+    Retained<C4Query> c4query = _queryCache.get(c4lang, queryString);
+    bool shared = (c4query != nullptr);
+    uint64_t compileNS = 0;
+    if (!c4query) {
+        auto start = chrono::steady_clock::now();
+        c4query = c4db->newQuery(c4lang, queryString, outErrPos);
+        if (!c4query)
+            return nullptr;
+        compileNS = chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now() - start).count();
+        shared = _queryCache.insert(c4lang, queryString, c4query);
+    }
+    Retained<CBLQuery> query = new CBLQuery(this, std::move(c4query), *_c4db, c4lang, queryString, shared);
+    query->_compileNS = compileNS;
+    return query;
+}
+
+
+Retained<CBLQuery> CBLDatabase::createKeysetQuery(const CBLKeysetQueryConfiguration &config,
+                                                  slice continuationToken) const
+{
+    if (config.collection.size == 0 || config.select.size == 0 || config.orderBy.size == 0
+            || config.pageSize == 0)
+        C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter,
+                       "Keyset query needs a collection, select, orderBy and pageSize");
+
+    // The first page and the later pages have different queries, so that the later pages can
+    // start with a range scan of the sort key's index:
+    string key = "(" + string(slice(config.orderBy)) + ")";
+    string dir = config.descending ? " DESC" : "";
+    string str = "SELECT " + string(slice(config.select)) + ", " + key + " AS _cbl_key, meta().id AS _cbl_id"
+               + " FROM " + string(slice(config.collection))
+               + " WHERE " + key + " IS VALUED";
+    if (config.where.size > 0)
+        str += " AND (" + string(slice(config.where)) + ")";
+    if (continuationToken) {
+        const char *op = config.descending ? "<" : ">";
+        str += " AND " + key + " " + op + "= $_cbl_key AND (" + key + " " + op + " $_cbl_key"
+             + " OR meta().id " + op + " $_cbl_id)";
+    }
+    str += " ORDER BY " + key + dir + ", meta().id" + dir + " LIMIT " + to_string(config.pageSize);
+
+    Retained<CBLQuery> query = createQuery(kCBLN1QLLanguage, slice(str), nullptr);
+    if (!query)
         return nullptr;
-    return new CBLQuery(this, std::move(c4query), *_c4db);
+    query->_keyset = true;
+
+    if (continuationToken || config.parameters) {
+        Encoder enc;
+        enc.beginDict();
+        for (Dict::iterator i(config.parameters); i; ++i) {
+            enc.writeKey(i.keyString());
+            enc.writeValue(i.value());
+        }
+        if (continuationToken) {
+            Doc token = Doc::fromJSON(continuationToken);
+            Array keyAndID = token.root().asArray();
+            if (keyAndID.count() != 2 || !keyAndID[1].asString())
+                C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter, "Invalid continuation token");
+            enc.writeKey("_cbl_key");
+            enc.writeValue(keyAndID[0]);
+            enc.writeKey("_cbl_id");
+            enc.writeValue(keyAndID[1]);
+        }
+        enc.endDict();
+        query->_encodeParameters(enc);
+    }
+    return query;
 }
 
 
@@ -96,6 +96,21 @@ bool CBLDatabase_EndTransaction(CBLDatabase* db, bool commit, CBLError* outError
     } catchAndBridge(outError)
 }
 
+bool CBLDatabase_EndTransactionWithDurability(CBLDatabase* db,
+                                              bool commit,
+                                              CBLDurability durability,
+                                              CBLError* outError) noexcept
+{
+    try {
+        db->endTransaction(commit, durability);
+        return true;
+    } catchAndBridge(outError)
+}
+
+void CBLDatabase_SetDeferredDurabilityInterval(CBLDatabase* db, unsigned intervalMS) noexcept {
+    db->setDeferredDurabilityInterval(intervalMS);
+}
+
 bool CBLDatabase_Delete(CBLDatabase* db, CBLError* outError) noexcept {
     try {
         db->closeAndDelete();
@@ -125,6 +140,46 @@ bool CBLDatabase_PerformMaintenance(CBLDatabase* db,
     } catchAndBridge(outError)
 }
 
+bool CBLDatabase_SetReaderPoolSize(CBLDatabase* db, unsigned size, CBLError* outError) noexcept {
+    try {
+        db->setReaderPoolSize(size);
+        return true;
+    } catchAndBridge(outError)
+}
+
+unsigned CBLDatabase_ReaderPoolSize(const CBLDatabase* db) noexcept {
+    return db->readerPoolSize();
+}
+
+void CBLDatabase_SetLockStatsEnabled(CBLDatabase* db, bool enabled) noexcept {
+    db->setLockStatsEnabled(enabled);
+}
+
+CBLLockStats CBLDatabase_GetLockStats(const CBLDatabase* db) noexcept {
+    return db->lockStats();
+}
+
+void CBLDatabase_ResetLockStats(CBLDatabase* db) noexcept {
+    db->resetLockStats();
+}
+
+bool CBLDatabase_SetWriteQueueOptions(CBLDatabase* db,
+                                      const CBLWriteQueueOptions* options,
+                                      CBLError* outError) noexcept
+{
+    try {
+        db->setWriteQueueOptions(*options);
+        return true;
+    } catchAndBridge(outError)
+}
+
+bool CBLDatabase_FlushWriteQueue(CBLDatabase* db, CBLError* outError) noexcept {
+    try {
+        db->flushWriteQueue();
+        return true;
+    } catchAndBridge(outError)
+}
+
 
 FLString CBLDatabase_Name(const CBLDatabase* db) noexcept {
     return db->name();
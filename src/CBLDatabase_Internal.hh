@@ -24,16 +24,25 @@
 #include "c4Collection.hh"
 #include "c4Database.hh"
 #include "c4Observer.hh"
+#include "DurabilitySyncer.hh"
 #include "Error.hh"
 #include "Internal.hh"
 #include "Listener.hh"
+#include "LockStats.hh"
+#include "OptionalMutex.hh"
+#include "QueryCache.hh"
+#include "QueryRunner.hh"
+#include "ReaderPool.hh"
+#include "WriteQueue.hh"
 #include "access_lock.hh"
 #include "fleece/function_ref.hh"
 #include "fleece/Mutable.hh"
 #include "fleece/RefCounted.hh"
+#include <atomic>
 #include <condition_variable>
 #include <string>
 #include <utility>
+#include <unordered_map>
 #include <unordered_set>
 
 CBL_ASSUME_NONNULL_BEGIN
@@ -97,7 +106,7 @@ public:
         CBLLog_Init();
         C4DatabaseConfig2 c4config = asC4Config(config);
         Retained<C4Database> c4db = C4Database::openNamed(name, c4config);
-        return new CBLDatabase(c4db, name, c4config.parentDirectory);
+        return new CBLDatabase(c4db, name, c4config.parentDirectory, config && config->singleThreaded);
     }
 
     void performMaintenance(CBLMaintenanceType type) {
@@ -111,8 +120,27 @@ public:
     }
 #endif
 
-    void beginTransaction()                          {_c4db->useLocked()->beginTransaction();}
-    void endTransaction(bool commit)                 {_c4db->useLocked()->endTransaction(commit);}
+    void setWriteQueueOptions(const CBLWriteQueueOptions &options) {_writeQueue->setOptions(options);}
+    void flushWriteQueue()                           {_writeQueue->flush();}
+
+    void setReaderPoolSize(unsigned size) {
+        _readerPool.resize(_name, _c4db->useLocked()->getConfiguration(), size);
+    }
+    unsigned readerPoolSize() const                  {return _readerPool.size();}
+
+    void setLockStatsEnabled(bool enabled)           {_lockStats.setEnabled(enabled);}
+    CBLLockStats lockStats() const                   {return _lockStats.stats();}
+    void resetLockStats()                            {_lockStats.reset();}
+
+    void beginTransaction();
+    void endTransaction(bool commit, CBLDurability durability =kCBLDurabilityNone);
+
+    void setDeferredDurabilityInterval(unsigned intervalMS) {
+        _durabilitySyncer.setInterval(std::chrono::milliseconds(intervalMS));
+    }
+
+    /** The collection's last sequence known to have been synced to disk. */
+    uint64_t lastDurableSequence(C4CollectionSpec spec, uint64_t lastSequence) const;
     
     void close();
     void closeAndDelete();
@@ -132,6 +160,7 @@ public:
         config.encryptionKey = asCBLKey(c4config.encryptionKey);
 #endif
         config.fullSync = (c4config.flags & kC4DB_DiskSyncFull) == kC4DB_DiskSyncFull;
+        config.singleThreaded = _singleThreaded;
         return config;
     }
 
@@ -142,6 +171,16 @@ public:
 
     std::string desc() const                         {return "CBLDatabase[" + _name.asString() + "]";}
 
+    /** True if the database was opened with `CBLDatabaseConfiguration.singleThreaded`. */
+    bool isSingleThreaded() const noexcept           {return _singleThreaded;}
+
+    /** Throws kC4ErrorUnsupported if the database is single-threaded. */
+    void checkMultiThreaded(const char *feature) const {
+        if (_singleThreaded)
+            C4Error::raise(LiteCoreDomain, kC4ErrorUnsupported,
+                           "%s can't be used with a single-threaded database", feature);
+    }
+
     
 #pragma mark - Collections:
     
@@ -188,6 +227,34 @@ public:
     Retained<CBLQuery> createQuery(CBLQueryLanguage language,
                                    slice queryString,
                                    int* _cbl_nullable outErrPos) const;
+
+    Retained<CBLQuery> createKeysetQuery(const CBLKeysetQueryConfiguration &config,
+                                         slice continuationToken) const;
+
+    /** Compiles a query without using the query cache. */
+    Retained<C4Query> compileQuery(C4QueryLanguage language,
+                                   slice queryString,
+                                   int* _cbl_nullable outErrPos) const
+    {
+        auto timing = timeLock(LockCategory::Query);
+        return _c4db->useLocked()->newQuery(language, queryString, outErrPos);
+    }
+
+    void setQueryCacheCapacity(size_t capacity) {
+        auto c4db = _c4db->useLocked();
+        _queryCache.setCapacity(capacity);
+    }
+
+    CBLQueryCacheStats queryCacheStats() const {
+        std::lock_guard<OptionalMutex> lock(_c4db->mutex());    // Works after closing, too
+        return _queryCache.stats();
+    }
+
+    /** Discards the compiled queries, which may not use the current indexes and collections. */
+    void clearQueryCache() {
+        auto c4db = _c4db->useLocked();
+        _queryCache.clear();
+    }
     
 
 #pragma mark - Listeners:
@@ -221,20 +288,24 @@ protected:
     friend struct CBLCollection;
     friend struct CBLDocument;
     friend struct CBLIndexUpdater;
+    friend struct CBLQuery;
     friend struct CBLQueryIndex;
+    friend struct CBLQueryTask;
     friend struct CBLReplicator;
     friend struct CBLURLEndpointListener;
     friend struct cbl_internal::CBLLocalEndpoint;
     friend struct cbl_internal::ListenerToken<CBLQueryChangeListener>;
     friend struct cbl_internal::ListenerToken<CBLCollectionDocumentChangeListener>;
+    friend class cbl_internal::WriteQueue;
+    friend class cbl_internal::DurabilitySyncer;
     
     /** The C4Database lock that adds a close() function for flagging that the c4database has been closed. It has
         a sentry guard setup tha will throw NotOpen when useLocked() function is called when the closed has been
         flagged. */
-    class C4DatabaseAccessLock: public litecore::access_lock<Retained<C4Database>> {
+    class C4DatabaseAccessLock: public cbl_internal::optional_access_lock<Retained<C4Database>> {
     public:
         C4DatabaseAccessLock(C4Database* db)
-        :access_lock(std::move(db))
+        :optional_access_lock(std::move(db))
         {
             _sentry = [this](C4Database* db) {
                 if (isClosedNoLock()) {
@@ -252,6 +323,8 @@ protected:
             return _closed;
         }
         
+        auto& mutex()                               {return getMutex();}
+        
         template <class CALLBACK>
         /** If the AccessLock is closed, the call will be ignored instead of letting the sentry throws. */
         void useLockedIgnoredWhenClosed(CALLBACK callback) {
@@ -269,6 +342,34 @@ protected:
     
     SharedC4DatabaseAccessLock c4db() const         {return _c4db;}
     
+    cbl_internal::WriteQueue* writeQueue() const    {return _writeQueue;}
+    
+    cbl_internal::QueryRunner* queryRunner() const  {return _queryRunner;}
+
+    /** Syncs every committed transaction to disk, by checkpointing the WAL, and records the
+        collections' sequences as durable. Returns false if a transaction is open, or if the
+        checkpoint couldn't complete, e.g. because another connection blocked it. */
+    bool syncToDisk();
+    
+    /** Returns a scope object that acquires the database's lock and records the time spent waiting
+        for and holding it, if lock stats are enabled. Declare it right before calling `useLocked()`,
+        in a scope that ends when the lock is released. */
+    auto timeLock(cbl_internal::LockCategory category) const {
+        auto &mutex = _c4db->mutex();
+        return LockStats::Scope<std::remove_reference_t<decltype(mutex)>>(_lockStats, mutex, category);
+    }
+    
+    /** Calls `callback(ReaderPool::Reader&)` with one of the reader pool's read-only C4Databases.
+        Returns false, without calling it, if no reader is available, or if a transaction is open
+        (readers can't see its uncommitted changes); the caller should then use the primary
+        C4Database. */
+    template <class CALLBACK>
+    bool useReader(CALLBACK callback) const {
+        if (_transactionDepth > 0)
+            return false;
+        return _readerPool.use(callback);
+    }
+    
     C4BlobStore* blobStore() const                  {return &(_c4db->useLocked()->getBlobStore());}
 
     template <class LISTENER, class... Args>
@@ -289,7 +390,7 @@ protected:
 
 private:
     
-    CBLDatabase(C4Database* _cbl_nonnull db, slice name_, slice dir_);
+    CBLDatabase(C4Database* _cbl_nonnull db, slice name_, slice dir_, bool singleThreaded);
 
     virtual ~CBLDatabase();
 
@@ -388,6 +489,15 @@ private:
     /** Close the scopes and collections, and access lock. Must call under _c4db lock. */
     void _closed();
     
+    /** Tracks the collections whose document cache is enabled; their cached documents retain them,
+        so `_closed()` disables the caches to break the cycles. Must call under _c4db lock. */
+    void documentCacheEnabled(CBLCollection* collection, bool enabled) {
+        if (enabled)
+            _documentCacheCollections.insert(collection);
+        else
+            _documentCacheCollections.erase(collection);
+    }
+    
     template <class T> using Listeners = cbl_internal::Listeners<T>;
 
     using ScopesMap = std::unordered_map<slice, Retained<CBLScope>>;
@@ -397,12 +507,36 @@ private:
     
     alloc_slice const                           _name;
     alloc_slice const                           _dir;
+    bool const                                  _singleThreaded;        // No locking
     
+    std::unordered_set<CBLCollection*>          _documentCacheCollections; // Under _c4db lock
     Retained<CBLCollection>                     _defaultCollection;     // Internal default collection
     
     // For sending notifications:
     NotificationQueue                           _notificationQueue;
     
+    // For committing asynchronous saves:
+    Retained<cbl_internal::WriteQueue>          _writeQueue;
+    
+    // For concurrent reads:
+    mutable cbl_internal::ReaderPool            _readerPool;
+    std::atomic<int>                            _transactionDepth {0};  // Nesting of explicit transactions
+    
+    // For running asynchronous queries:
+    Retained<cbl_internal::QueryRunner>         _queryRunner;
+    
+    // For reusing compiled queries:
+    mutable cbl_internal::QueryCache            _queryCache;            // Under _c4db lock
+    
+    // For lock contention statistics:
+    mutable cbl_internal::LockStats             _lockStats;
+    
+    // For per-transaction durability:
+    CBLDurability                               _pendingDurability {kCBLDurabilityNone}; // Under _c4db lock
+    cbl_internal::DurabilitySyncer              _durabilitySyncer;
+    mutable std::mutex                          _durableMutex;
+    std::unordered_map<std::string, uint64_t>   _durableSequences;  // Keyed by collection path
+    
     // For Active Services:
     bool                                        _stopping {false};
     mutable std::mutex                          _stopMutex;
@@ -28,6 +28,7 @@
 
 CBL_PUBLIC const bool kCBLDefaultDatabaseFullSync = false;
 CBL_PUBLIC const bool kCBLDefaultDatabaseMmapDisabled = false;
+CBL_PUBLIC const bool kCBLDefaultDatabaseSingleThreaded = false;
 
 #pragma mark - CBLLogFileConfiguration
 
@@ -25,6 +25,7 @@
 #include "c4Private.h"
 #include "betterassert.hh"
 #include <mutex>
+#include <vector>
 
 #ifdef COUCHBASE_ENTERPRISE
 #include "CBLEncryptable_Internal.hh"
@@ -50,16 +51,29 @@ CBLDocument::CBLDocument(slice docID, CBLCollection *collection, C4Document *c4d
 ,_c4doc(c4doc)
 ,_mutable(isMutable)
 {
+    if (collection && collection->database()->isSingleThreaded())
+        _c4doc.setSingleThreaded();
     if (c4doc) {
-        c4doc->extraInfo() = {this, nullptr};
+        // If another document already owns the C4Document's extraInfo, this is a copy of it;
+        // keep that one alive instead of taking the extraInfo away, since `containing` finds the
+        // blobs in the shared revision body through it:
+        if (auto owner = (CBLDocument*)c4doc->extraInfo().pointer; owner)
+            _c4docOwner = owner;
+        else
+            c4doc->extraInfo() = {this, nullptr};
         _revID = c4doc->selectedRev().revID;
+        if (!isMutable) {
+            _loadedDoc = c4doc;
+            _loadedBody = c4doc->getRevisionBody();
+        }
     }
+    updateRevisionInfo(c4doc);
 }
 
 
 CBLDocument::~CBLDocument() {
     auto c4doc = _c4doc.useLocked();
-    if (c4doc)
+    if (c4doc && c4doc->extraInfo().pointer == this)
         c4doc->extraInfo() = {nullptr, nullptr};
 }
 
@@ -114,7 +128,7 @@ bool CBLDocument::save(CBLCollection* collection, const SaveOptions &opt) {
         RetainedConst<CBLDocument> conflictingDoc = nullptr;
         
         // Note: shared lock b/w database and collection
-        collection->useLocked([&](C4Collection* c4col) {
+        collection->useLocked(LockCategory::DocumentWrite, [&](C4Collection* c4col) {
             auto c4db = c4col->getDatabase();
             C4Database::Transaction t(c4db);
             
@@ -134,7 +148,7 @@ bool CBLDocument::save(CBLCollection* collection, const SaveOptions &opt) {
                 checkCollectionMatches(_collection, collection);
                 
                 orignalDoc = c4doc.get();
-                savingDoc = orignalDoc;
+                savingDoc = revisionToUpdate(c4col, orignalDoc);
             } else {
                 // Make sure that the doc hasn't been changed during the save process:
                 precondition(c4doc.get() == orignalDoc);
@@ -152,21 +166,7 @@ bool CBLDocument::save(CBLCollection* collection, const SaveOptions &opt) {
             Retained<C4Document> newDoc = nullptr;
             conflictingDoc = nullptr;
             
-            if (savingDoc) {
-                // Update existing doc:
-                newDoc = savingDoc->update(body, revFlags);
-            } else {
-                // Create new doc:
-                C4DocPutRequest rq = {};
-                rq.allocedBody = {body.buf, body.size};
-                rq.docID = _docID;
-                rq.revFlags = revFlags;
-                rq.save = true;
-                C4Error c4err;
-                newDoc = c4col->putDocument(rq, nullptr, &c4err);
-                if (!newDoc && c4err != C4Error{LiteCoreDomain, kC4ErrorConflict})
-                    C4Error::raise(c4err);
-            }
+            newDoc = putRevision(c4col, savingDoc, body, revFlags);
             
             if (newDoc) {
                 // Success:
@@ -175,6 +175,7 @@ bool CBLDocument::save(CBLCollection* collection, const SaveOptions &opt) {
                 // HACK: Replace the inner reference of the c4doc with the one from newDoc.
                 c4doc.get() = std::move(newDoc);
                 _revID = c4doc->selectedRev().revID;
+                updateRevisionInfo(c4doc.get());
                 success = true;
             } else {
                 // Conflict:
@@ -215,12 +216,121 @@ bool CBLDocument::save(CBLCollection* collection, const SaveOptions &opt) {
 }
 
 
+void CBLDocument::saveAll(CBLCollection* collection,
+                          CBLDocument* const docs[],
+                          size_t count,
+                          CBLConcurrencyControl concurrency,
+                          bool* _cbl_nullable outResults)
+{
+    // Note: shared lock b/w database and collection
+    std::vector<Retained<C4Document>> newDocs(count);
+    collection->useLocked(LockCategory::DocumentWrite, [&](C4Collection* c4col) {
+        auto c4db = c4col->getDatabase();
+        C4Database::Transaction t(c4db);
+        for (size_t i = 0; i < count; ++i)
+            newDocs[i] = docs[i]->saveRevision(collection, c4col, concurrency);
+        t.commit();
+    });
+    
+    // Only install the new revisions once the transaction has been committed:
+    for (size_t i = 0; i < count; ++i) {
+        if (outResults)
+            outResults[i] = (newDocs[i] != nullptr);
+        if (newDocs[i])
+            docs[i]->installRevision(collection, std::move(newDocs[i]));
+    }
+}
+
+
+void CBLDocument::installRevision(CBLCollection* collection, Retained<C4Document> newDoc) {
+    auto c4doc = _c4doc.useLocked();
+    _collection = collection;
+    c4doc.get() = std::move(newDoc);
+    _revID = c4doc->selectedRev().revID;
+    updateRevisionInfo(c4doc.get());
+}
+
+
+Retained<C4Document> CBLDocument::saveRevision(CBLCollection* collection,
+                                               C4Collection* c4col,
+                                               CBLConcurrencyControl concurrency)
+{
+    auto c4doc = _c4doc.useLocked();
+    checkMutable();
+    checkCollectionMatches(_collection, collection);
+    
+    C4RevisionFlags revFlags;
+    alloc_slice body = encodeBody(collection->database(), c4col->getDatabase(), false, revFlags);
+    
+    Retained<C4Document> savingDoc = revisionToUpdate(c4col, c4doc.get());
+    Retained<C4Document> newDoc = putRevision(c4col, savingDoc, body, revFlags);
+    if (!newDoc && concurrency == kCBLConcurrencyControlLastWriteWins) {
+        // Last-write-wins; load current revision and retry. Nothing else can write to the
+        // collection while it is locked, so the retry will not conflict again:
+        Retained<C4Document> current = c4col->getDocument(_docID, true, kDocGetCurrentRev);
+        newDoc = putRevision(c4col, current, body, revFlags);
+    }
+    return newDoc;
+}
+
+
+Retained<C4Document> CBLDocument::revisionToUpdate(C4Collection* c4col, C4Document* _cbl_nullable c4doc) const {
+    if (!c4doc || c4doc->collection() == c4col)
+        return c4doc;
+    // The document was read through one of the database's read-only readers. Update the same
+    // revision in the primary C4Database; if it's been changed since, saving a new document
+    // will fail with a conflict:
+    Retained<C4Document> current = c4col->getDocument(_docID, true, kDocGetCurrentRev);
+    if (current && current->selectedRev().revID == c4doc->selectedRev().revID)
+        return current;
+    return nullptr;
+}
+
+
+Retained<C4Document> CBLDocument::putRevision(C4Collection* c4col,
+                                              C4Document* _cbl_nullable savingDoc,
+                                              const alloc_slice &body,
+                                              C4RevisionFlags revFlags) const
+{
+    if (savingDoc) {
+        // Update existing doc:
+        return savingDoc->update(body, revFlags);
+    } else {
+        // Create new doc:
+        C4DocPutRequest rq = {};
+        rq.allocedBody = {body.buf, body.size};
+        rq.docID = _docID;
+        rq.revFlags = revFlags;
+        rq.save = true;
+        C4Error c4err;
+        Retained<C4Document> newDoc = c4col->putDocument(rq, nullptr, &c4err);
+        if (!newDoc && c4err != C4Error{LiteCoreDomain, kC4ErrorConflict})
+            C4Error::raise(c4err);
+        return newDoc;
+    }
+}
+
+
+static std::atomic<uint64_t> sReusedBodyCount {0};
+
+
 alloc_slice CBLDocument::encodeBody(CBLDatabase* db,
                                     C4Database* c4db,
                                     bool releaseNewBlob,
                                     C4RevisionFlags &outRevFlags) const
 {
     auto c4doc = _c4doc.useLocked();
+    
+    // If the properties haven't been changed, the current revision's body can be reused as is:
+    if (c4doc) {
+        slice revBody = c4doc->getRevisionBody();
+        if (revBody && propertiesMatchRevisionBody(revBody)) {
+            outRevFlags = c4doc->selectedRev().flags & kRevHasAttachments;
+            ++sReusedBodyCount;
+            return alloc_slice(revBody);
+        }
+    }
+    
     // Save new blobs and check encryptables in arrays:
     bool hasBlobs = saveBlobsAndCheckEncryptables(db, releaseNewBlob);
     outRevFlags = hasBlobs ? kRevHasAttachments : 0;
@@ -236,6 +346,50 @@ alloc_slice CBLDocument::encodeBody(CBLDatabase* db,
 }
 
 
+uint64_t CBLDocument::reusedBodyCount() {
+    return sReusedBodyCount;
+}
+
+
+// Returns true if a mutable collection, or any mutable collection nested in it, has been changed.
+// Immutable collections can't contain changes, so they aren't traversed.
+static bool containsChanges(Value value) {
+    if (MutableDict dict = value.asDict().asMutable(); dict) {
+        if (dict.isChanged())
+            return true;
+        for (Dict::iterator i(dict); i; ++i) {
+            if (containsChanges(i.value()))
+                return true;
+        }
+    } else if (MutableArray array = value.asArray().asMutable(); array) {
+        if (array.isChanged())
+            return true;
+        for (Array::iterator i(array); i; ++i) {
+            if (containsChanges(i.value()))
+                return true;
+        }
+    }
+    return false;
+}
+
+
+bool CBLDocument::propertiesMatchRevisionBody(slice body) const {
+    if (_fromJSON)
+        return false;
+    if (!_properties)
+        return true;    // Properties haven't been accessed
+    
+    FLDict root = ValueFromData(body).asDict();
+    Dict props = _properties.asDict();
+    if ((FLDict)props == root)
+        return true;    // Immutable properties of the revision
+    
+    // Mutable properties, which must be an unchanged copy of the revision's root:
+    MutableDict mutableProps = props.asMutable();
+    return mutableProps && (FLDict)mutableProps.source() == root && !containsChanges(mutableProps);
+}
+
+
 #pragma mark - REPLICATOR CONFLICT RESOLUTION:
 
 
@@ -251,7 +405,7 @@ bool CBLDocument::resolveConflict(Resolution resolution, const CBLDocument * _cb
     slice remoteRevID(c4doc->selectedRev().revID), localRevID(c4doc->revID());
     
     // Note: shared lock b/w database and collection
-    return _collection->useLocked<bool>([&](C4Collection *c4col) {
+    return _collection->useLocked<bool>(LockCategory::DocumentWrite, [&](C4Collection *c4col) {
         auto c4db = c4col->getDatabase();
         C4Database::Transaction t(c4db);
 
@@ -290,6 +444,7 @@ bool CBLDocument::resolveConflict(Resolution resolution, const CBLDocument * _cb
 
         c4doc->save();
         t.commit();
+        updateRevisionInfo(c4doc.get());
         return true;
     });
 }
@@ -356,6 +511,14 @@ CBLBlob* CBLDocument::getBlob(FLDict dict, const C4BlobKey &key) {
 }
 
 
+CBLBlob* ReadDocumentBlobs::getBlob(FLDict dict, const C4BlobKey &key) {
+    auto i = _blobs.find(dict);
+    if (i == _blobs.end())
+        i = _blobs.emplace(dict, new CBLBlob(_db, dict, key)).first;
+    return i->second;
+}
+
+
 #ifdef COUCHBASE_ENTERPRISE
 
 CBLEncryptable* CBLDocument::getEncryptableValue(FLDict dict) {
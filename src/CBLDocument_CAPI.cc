@@ -52,6 +52,11 @@ FLSliceResult CBLDocument_GetRevisionHistory(const CBLDocument* doc) noexcept {
     return FLSliceResult(doc->getRevisionHistory());
 }
 
+/** Private API */
+uint64_t CBLDocument_ReusedBodyCount(void) noexcept {
+    return CBLDocument::reusedBodyCount();
+}
+
 FLMutableDict CBLDocument_MutableProperties(CBLDocument* doc) noexcept {
     return doc->mutableProperties();
 }
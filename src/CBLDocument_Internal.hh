@@ -19,11 +19,13 @@
 #pragma once
 #include "CBLDocument.h"
 #include "Internal.hh"
+#include "OptionalMutex.hh"
 #include "c4Document.hh"
 #include "access_lock.hh"
 #include "fleece/Expert.hh"
 #include "fleece/Fleece.hh"
 #include "fleece/Mutable.hh"
+#include <atomic>
 #include <climits>
 #include <sstream>
 #include <unordered_map>
@@ -33,6 +35,43 @@ CBL_ASSUME_NONNULL_BEGIN
 struct CBLBlob;
 struct CBLNewBlob;
 
+namespace cbl_internal {
+    class WriteQueue;
+
+    /** Attached to the extraInfo of the C4Document read by `CBLCollection::readDocument` while its
+        callback runs, so that `CBLBlob::getBlob` can find the blobs in the callback's properties.
+        The blobs it creates are released when the callback returns. */
+    class ReadDocumentBlobs {
+    public:
+        ReadDocumentBlobs(CBLDatabase* db, C4Document* c4doc)
+        :_db(db)
+        ,_c4doc(c4doc)
+        {
+            _c4doc->extraInfo() = {this, &tag};
+        }
+
+        ~ReadDocumentBlobs() {
+            _c4doc->extraInfo() = {nullptr, nullptr};
+        }
+
+        /** Returns the instance attached to a C4Document, if any. */
+        static ReadDocumentBlobs* _cbl_nullable attachedTo(C4Document* _cbl_nullable c4doc) {
+            if (c4doc && c4doc->extraInfo().destructor == &tag)
+                return (ReadDocumentBlobs*)c4doc->extraInfo().pointer;
+            return nullptr;
+        }
+
+        CBLBlob* getBlob(FLDict dict, const C4BlobKey&);
+
+    private:
+        static void tag(void*) { }  // Identifies the extraInfo; never called, since it's detached
+
+        CBLDatabase*                                        _db;
+        C4Document*                                         _c4doc;
+        std::unordered_map<FLDict, Retained<CBLBlob>>       _blobs;
+    };
+}
+
 #ifdef COUCHBASE_ENTERPRISE
 struct CBLEncryptable;
 #endif
@@ -54,8 +93,12 @@ public:
     {
         if (otherDoc->isMutable()) {
             auto other = otherDoc->_c4doc.useLocked();
+            // Only the mutable collections need to be copied; the immutable ones are shared, and
+            // will be promoted to mutable lazily if this copy modifies them. The shared values
+            // are kept alive by the C4Document or JSON Doc that both documents now reference.
+            _fromJSON = otherDoc->_fromJSON;
             if (otherDoc->_properties)
-                _properties = otherDoc->_properties.asDict().mutableCopy(kFLDeepCopyImmutables);
+                _properties = otherDoc->_properties.asDict().mutableCopy(kFLDeepCopy);
         }
     }
 
@@ -69,13 +112,16 @@ public:
     :CBLDocument(docID, col, nullptr, false)
     {
         _properties = body;
+        _immutableProperties = body;
         _revID = revID;
     }
 
 
     static CBLDocument* _cbl_nullable containing(Value value) {
         C4Document* doc = C4Document::containingValue(value);
-        return doc ? (CBLDocument*)doc->extraInfo().pointer : nullptr;
+        if (!doc || cbl_internal::ReadDocumentBlobs::attachedTo(doc))
+            return nullptr;
+        return (CBLDocument*)doc->extraInfo().pointer;
     }
 
 
@@ -85,16 +131,13 @@ public:
     CBLDatabase* _cbl_nullable database() const;
     
     CBLCollection* _cbl_nullable collection() const {return _collection;}
-    bool exists() const                         {return _c4doc.useLocked().get() != nullptr;}
+    bool exists() const                         {return _exists.load(std::memory_order_acquire);}
     bool isMutable() const                      {return _mutable;}
     slice docID() const                         {return _docID;}
     slice revisionID() const                    {return _revID;}
     uint64_t timestamp() const                  {return C4Document::getRevIDTimestamp(_revID);}
     
-    uint64_t sequence() const {
-        auto c4doc = _c4doc.useLocked();
-        return c4doc ? static_cast<uint64_t>(c4doc->selectedRev().sequence) : 0;
-    }
+    uint64_t sequence() const                   {return _sequence.load(std::memory_order_acquire);}
 
     alloc_slice canonicalRevisionID() const {
         auto c4doc = _c4doc.useLocked();
@@ -104,17 +147,20 @@ public:
         return c4doc->getSelectedRevIDGlobalForm();
     }
 
-    C4RevisionFlags revisionFlags() const {
-        auto c4doc = _c4doc.useLocked();
-        return c4doc ? c4doc->selectedRev().flags : (kRevNew | kRevLeaf);
-    }
+    C4RevisionFlags revisionFlags() const       {return _revFlags.load(std::memory_order_acquire);}
     
     alloc_slice getRevisionHistory() const;
     
+    /** The number of saves that reused the current revision's body instead of encoding the
+        properties, in this process. For testing. */
+    static uint64_t reusedBodyCount();
+    
 #pragma mark - Properties:
 
 
     Dict properties() const {
+        if (!_mutable)
+            return immutableProperties();
         //TODO: Convert this to use C4Document::getProperties()
         auto c4doc = _c4doc.useLocked();
         if (!_properties) {
@@ -153,11 +199,7 @@ public:
 
 
     alloc_slice propertiesAsJSON() const {
-        auto c4doc = _c4doc.useLocked();
-        if (!_mutable && c4doc)
-            return c4doc->bodyAsJSON(false);        // fast path
-        else
-            return properties().toJSON();
+        return properties().toJSON();
     }
 
 
@@ -213,6 +255,14 @@ public:
     
     bool save(CBLCollection* collection, const SaveOptions &opt);
     
+    // Saves multiple documents in a single transaction. If outResults is given, each entry is
+    // set to true if the document was saved, or false if it was skipped due to a conflict.
+    static void saveAll(CBLCollection* collection,
+                        CBLDocument* const docs[],
+                        size_t count,
+                        CBLConcurrencyControl concurrency,
+                        bool* _cbl_nullable outResults);
+    
 
 #pragma mark - Conflict resolution:
 
@@ -225,6 +275,7 @@ public:
         _revID = revID;
         _properties = nullptr;
         _fromJSON = nullptr;
+        updateRevisionInfo(c4doc.get());
         return true;
     }
 
@@ -239,8 +290,10 @@ public:
         while (c4doc->selectNextLeafRevision(true, true))
             if (c4doc->selectedRev().flags & kRevIsConflict) {
                 _revID = c4doc->selectedRev().revID;
+                updateRevisionInfo(c4doc.get());
                 return true;
             }
+        updateRevisionInfo(c4doc.get());
         return false;
     }
 
@@ -269,6 +322,8 @@ public:
 private:
     
     friend struct CBLCollection;
+    friend struct CBLDocumentEnumerator;
+    friend class cbl_internal::WriteQueue;
     
     CBLDocument(slice docID, CBLCollection* _cbl_nullable collection,
                 C4Document* _cbl_nullable c4doc, bool isMutable);
@@ -294,6 +349,29 @@ private:
     //
     bool saveBlobsAndCheckEncryptables(CBLDatabase *db, bool releaseNewBlob) const;
     
+    // Encode and save a new revision of the document. Must be called under the collection lock
+    // inside a transaction. Returns the new C4Document, or null if there is a conflict that
+    // isn't resolved by the concurrency control. The caller must install the returned
+    // C4Document into _c4doc after the transaction has been committed.
+    Retained<C4Document> saveRevision(CBLCollection* collection,
+                                      C4Collection* c4col,
+                                      CBLConcurrencyControl concurrency);
+    
+    // Install a new revision returned by saveRevision, after its transaction has been committed.
+    void installRevision(CBLCollection* collection, Retained<C4Document> newDoc);
+    
+    // Returns the C4Document that a new revision of c4doc should be put on, in the primary
+    // C4Database's collection c4col. That's c4doc itself unless it came from a reader of the
+    // database's reader pool.
+    Retained<C4Document> revisionToUpdate(C4Collection* c4col, C4Document* _cbl_nullable c4doc) const;
+    
+    // Put the encoded body as a new revision of savingDoc, or as a new document if savingDoc
+    // is null. Returns null if there is a conflict.
+    Retained<C4Document> putRevision(C4Collection* c4col,
+                                     C4Document* _cbl_nullable savingDoc,
+                                     const alloc_slice &body,
+                                     C4RevisionFlags revFlags) const;
+    
     // Encode the document body and install new blobs if found into the database.
     //
     // The releaseNewBlob option tells whether the new blob object should be released after
@@ -306,6 +384,36 @@ private:
                            C4Database* c4db,
                            bool releaseNewBlob,
                            C4RevisionFlags &outRevFlags) const;
+    
+    // Immutable documents never change their properties, so they're parsed from the body of the
+    // revision the document was loaded with, without locking. Threads racing to parse it produce
+    // the same pointer, so the last one to store it wins harmlessly.
+    Dict immutableProperties() const {
+        FLDict props = _immutableProperties.load(std::memory_order_acquire);
+        if (!props) {
+            if (_loadedBody)
+                props = ValueFromData(_loadedBody).asDict();
+            if (!props)
+                props = Dict::emptyDict();
+            _immutableProperties.store(props, std::memory_order_release);
+        }
+        return props;
+    }
+
+    // Copies the selected revision's sequence and flags into the atomics read by `sequence()`,
+    // `revisionFlags()` and `exists()`. Must be called under the _c4doc lock whenever it changes
+    // the C4Document or its selected revision.
+    void updateRevisionInfo(const C4Document* _cbl_nullable c4doc) {
+        _sequence.store(c4doc ? uint64_t(c4doc->selectedRev().sequence) : 0, std::memory_order_release);
+        _revFlags.store(c4doc ? c4doc->selectedRev().flags : C4RevisionFlags(kRevNew | kRevLeaf),
+                        std::memory_order_release);
+        _exists.store(c4doc != nullptr, std::memory_order_release);
+    }
+
+    // Returns true if the properties are still identical to the body of the selected revision
+    // of the C4Document, so that the body can be reused instead of being encoded again.
+    // Must be called under the _c4doc lock.
+    bool propertiesMatchRevisionBody(slice body) const;
 
     // Custom object cache:
     using ValueToBlobMap = std::unordered_map<FLDict, Retained<CBLBlob>>;
@@ -314,16 +422,24 @@ private:
 #endif
 
     Retained<CBLCollection>       _collection;      // Collection (null for new doc)
-    litecore::access_lock<Retained<C4Document>>  _c4doc; // LiteCore doc (null for new doc)
+    optional_access_lock<Retained<C4Document>>   _c4doc; // LiteCore doc (null for new doc)
     alloc_slice const             _docID;           // Document ID (never empty)
     mutable alloc_slice           _revID;           // Revision ID
     fleece::Doc                   _fromJSON;        // Properties read from JSON
     mutable fleece::RetainedValue _properties;      // Properties, initialized lazily
+    Retained<C4Document>          _loadedDoc;       // Immutable doc's C4Document as loaded
+    slice                         _loadedBody;      // Body of _loadedDoc's selected revision
+    mutable std::atomic<FLDict>   _immutableProperties {nullptr}; // Immutable doc's properties
+    std::atomic<uint64_t>         _sequence {0};    // Selected revision's sequence
+    std::atomic<C4RevisionFlags>  _revFlags {C4RevisionFlags(kRevNew | kRevLeaf)}; // ...and flags
+    std::atomic<bool>             _exists {false};  // True iff _c4doc is non-null
     ValueToBlobMap                _blobs;           // Maps Dicts in _properties to CBLBlobs
 #ifdef COUCHBASE_ENTERPRISE
     ValueToEncryptableMap         _encryptables;    // Maps Dicts in _properties to CBLEncryptables
 #endif
+    RetainedConst<CBLDocument>    _c4docOwner;      // Owner of _c4doc's extraInfo, if not me
     bool const                    _mutable {false}; // True iff I am mutable
+    bool                          _shared {false};  // True if handed out by the document cache
 };
 
 CBL_ASSUME_NONNULL_END
@@ -73,6 +73,10 @@ FLMutableArray CBLCollection_GetIndexesInfo(const CBLCollection* collection,
     FLSliceResult CBLDocument_CanonicalRevisionID(const CBLDocument* doc) CBLAPI;
 
     FLSliceResult CBLDocument_GetRevisionHistory(const CBLDocument* doc) CBLAPI;
+
+    /** Returns the number of document saves in this process that reused the current revision's
+        body instead of encoding the document's properties. For testing. */
+    uint64_t CBLDocument_ReusedBodyCount(void) CBLAPI;
     
     FLSlice CBLReplicator_UserAgent(const CBLReplicator* repl) CBLAPI;
 
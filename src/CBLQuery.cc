@@ -21,6 +21,7 @@
 #include "CBLQuery_Internal.hh"
 #include "CBLEncryptable_Internal.hh"
 #include "c4Log.h"
+#include <cerrno>
 
 
 using namespace std;
@@ -51,6 +52,79 @@ void ListenerToken<CBLQueryChangeListener>::setEnabled(bool enabled) {
 }
 
 
+void CBLQuery::executeBatch(Array parameterSets,
+                            CBLQueryBatchCallback callback,
+                            void* _cbl_nullable context)
+{
+    uint32_t count = parameterSets.count();
+    for (uint32_t i = 0; i < count; ++i) {
+        if (!parameterSets[i].asDict())
+            C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter,
+                           "Parameter set %u is not a dictionary", i);
+    }
+
+    Encoder enc;    // Reused for every parameter set
+    for (uint32_t i = 0; i < count; ++i) {
+        enc.writeValue(parameterSets[i]);
+        alloc_slice encodedParameters = enc.finish();
+        if (!encodedParameters)
+            C4Error::raise(FleeceDomain, enc.error(), "%s", enc.errorMessage());
+        enc.reset();
+        Retained<CBLResultSet> results = executeWith(encodedParameters);
+        if (!callback(context, i, results))
+            break;
+    }
+}
+
+
+Retained<CBLQueryTask> CBLQuery::executeAsync(unsigned timeoutMS,
+                                              CBLQueryCompletionCallback completion,
+                                              void* _cbl_nullable context)
+{
+    _database->checkMultiThreaded("Asynchronous queries");
+    auto deadline = CBLQueryTask::clock::time_point::max();
+    if (timeoutMS > 0)
+        deadline = CBLQueryTask::clock::now() + chrono::milliseconds(timeoutMS);
+    auto task = retained(new CBLQueryTask(this, deadline, completion, context));
+    _database->queryRunner()->enqueue(task);
+    return task;
+}
+
+
+// Finds the index names and full scans in the query plan lines of `explain()`'s output, such as
+// "SEARCH kv_default USING INDEX byName (name>?)" or "SCAN kv_default".
+CBLQuery::PlanInfo CBLQuery::parsePlan(slice explanation) {
+    PlanInfo info;
+    string text(explanation);
+    size_t pos = 0;
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == string::npos)
+            end = text.size();
+        string line = text.substr(pos, end - pos);
+        pos = end + 1;
+
+        size_t scan = line.find("SCAN ");
+        if (scan == string::npos && line.find("SEARCH ") == string::npos)
+            continue;
+        if (size_t i = line.find(" INDEX "); i != string::npos && line.find("VIRTUAL TABLE") == string::npos) {
+            string name = line.substr(i + 7);
+            name = name.substr(0, name.find(' '));
+            info.indexes.append(slice(name));
+        } else if (scan != string::npos) {
+            // A virtual table is a full-text index, whose table is named "<collection>::<index>":
+            string table = line.substr(scan + 5);
+            table = table.substr(0, table.find(' '));
+            if (size_t sep = table.find("::"); sep != string::npos)
+                info.indexes.append(slice(table.substr(sep + 2)));
+            else
+                info.fullScan = true;
+        }
+    }
+    return info;
+}
+
+
 CBLResultSet::CBLResultSet(CBLQuery* query, C4Query::Enumerator qe)
 :_query(query)
 ,_enum(std::move(qe))
@@ -66,35 +140,130 @@ CBLResultSet::~CBLResultSet() {
 bool CBLResultSet::next() {
     _asArray = nullptr;
     _asDict = nullptr;
-    _blobs.clear();
+    if (_blobs && !_blobs->empty())
+        _blobs->clear();
 #ifdef COUCHBASE_ENTERPRISE
-    _encryptables.clear();
+    if (_encryptables && !_encryptables->empty())
+        _encryptables->clear();
 #endif
     
-    if (_enum.next()) {
+    _hasRow = _enum.next();
+    if (_hasRow) {
         if (!_fleeceDoc) {
             // As soon as I read the first row, associate myself with the `Doc` backing the Fleece
             // data, so that the `getBlob()` method can find me.
-            if (Value v = column(0); v) {
+            if (Value v = _enum.column(0); v) {
                 _fleeceDoc = Doc::containing(v);
                 if (!_fleeceDoc.setAssociated(this, "CBLResultSet"))
                     C4Warn("Couldn't associate CBLResultSet with FLDoc %p", FLDoc(_fleeceDoc));
             }
         }
+        if (_profiling && _stats.rowsReturned++ == 0)
+            _stats.firstRowNS = elapsedNS(_startTime);
         return true;
     } else {
         _fleeceDoc = nullptr;
+        if (_profiling && _stats.enumerationNS == 0)
+            _stats.enumerationNS = elapsedNS(_startTime);
         return false;
     }
 }
 
 
+void CBLResultSet::startProfiling(clock::time_point start, bool usedReader) {
+    _profiling = true;
+    _startTime = start;
+    _stats.executeNS = elapsedNS(start);
+    _stats.usedReader = usedReader;
+}
+
+
+CBLQueryStats CBLResultSet::stats() const {
+    CBLQueryStats stats = _stats;
+    stats.compileNS = _query->compileNS();
+    if (_profiling) {
+        auto &plan = _query->planInfo();
+        stats.indexesUsed = plan.indexes;
+        stats.fullScan = plan.fullScan;
+    }
+    return stats;
+}
+
+
+// Stores a column value, converted to `type`, in `values[row]`. Returns false, storing zero,
+// if the value is missing or null, or can't be converted.
+static bool storeColumnValue(FLValue value, CBLColumnType type, void *values, unsigned row) {
+    FLValueType valueType = FLValue_GetType(value);
+    bool numeric = (valueType == kFLNumber || valueType == kFLBoolean);
+    switch (type) {
+        case kCBLColumnInt64:
+            static_cast<int64_t*>(values)[row] = numeric ? FLValue_AsInt(value) : 0;
+            return numeric;
+        case kCBLColumnDouble:
+            static_cast<double*>(values)[row] = numeric ? FLValue_AsDouble(value) : 0.0;
+            return numeric;
+        case kCBLColumnBool:
+            static_cast<bool*>(values)[row] = numeric && FLValue_AsBool(value);
+            return numeric;
+        case kCBLColumnString: {
+            bool isString = (valueType == kFLString);
+            static_cast<FLSlice*>(values)[row] = isString ? FLValue_AsString(value) : kFLSliceNull;
+            return isString;
+        }
+    }
+    return false;
+}
+
+
+unsigned CBLResultSet::nextBatch(unsigned maxRows,
+                                 const CBLColumnSpec* columnSpecs,
+                                 CBLColumnBuffer* outBuffers,
+                                 unsigned columnCount)
+{
+    unsigned nCols = _query->columnCount();
+    for (unsigned i = 0; i < columnCount; ++i) {
+        if (columnSpecs[i].column >= nCols)
+            C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter,
+                           "Column index %u is out of range", columnSpecs[i].column);
+        if (columnSpecs[i].type > kCBLColumnString)
+            C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter, "Invalid column type");
+        if (!outBuffers[i].values)
+            C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter, "Missing column values array");
+    }
+
+    unsigned row = 0;
+    for (; row < maxRows && next(); ++row) {
+        auto bit = uint8_t(1 << (row % 8));
+        for (unsigned i = 0; i < columnCount; ++i) {
+            const CBLColumnSpec &spec = columnSpecs[i];
+            CBLColumnBuffer &buffer = outBuffers[i];
+            bool stored = storeColumnValue(column(spec.column), spec.type, buffer.values, row);
+            if (buffer.nulls) {
+                if (stored)
+                    buffer.nulls[row / 8] &= uint8_t(~bit);
+                else
+                    buffer.nulls[row / 8] |= bit;
+            }
+        }
+    }
+    return row;
+}
+
+
 Value CBLResultSet::property(slice prop) const {
     int col = _query->columnNamed(prop);
     return (col >= 0) ? column(col) : nullptr;
 }
 
 
+unsigned CBLResultSet::columnValues(FLValue outValues[], unsigned maxColumns) const {
+    unsigned n = min(maxColumns, _query->columnCount());
+    for (unsigned i = 0; i < n; ++i)
+        outValues[i] = column(i);
+    return n;
+}
+
+
 Array CBLResultSet::asArray() const {
     if (!_asArray) {
         auto array = MutableArray::newArray();
@@ -126,6 +295,143 @@ Dict CBLResultSet::asDict() const {
 }
 
 
+// Appends compact JSON to `out`, indented over multiple lines; `indent` is the initial depth.
+static void appendPrettyJSON(string &out, slice json, int indent) {
+    auto newline = [&] { out += '\n'; out.append(2 * indent, ' '); };
+    bool inString = false, escaped = false;
+    for (size_t i = 0; i < json.size; ++i) {
+        char c = char(json[i]);
+        if (inString) {
+            out += c;
+            if (escaped)
+                escaped = false;
+            else if (c == '\\')
+                escaped = true;
+            else if (c == '"')
+                inString = false;
+            continue;
+        }
+        switch (c) {
+            case '"':
+                inString = true;
+                out += c;
+                break;
+            case '{': case '[':
+                out += c;
+                if (i + 1 < json.size && (json[i + 1] == '}' || json[i + 1] == ']')) {
+                    out += char(json[++i]);    // Empty collection
+                } else {
+                    ++indent;
+                    newline();
+                }
+                break;
+            case '}': case ']':
+                --indent;
+                newline();
+                out += c;
+                break;
+            case ',':
+                out += c;
+                newline();
+                break;
+            case ':':
+                out += ": ";
+                break;
+            default:
+                out += c;
+                break;
+        }
+    }
+}
+
+
+void CBLResultSet::writeJSON(const CBLResultJSONOptions &options,
+                             CBLJSONWriteCallback callback,
+                             void* _cbl_nullable context)
+{
+    unsigned nCols = _query->columnCount();
+    vector<unsigned> columns;
+    if (options.columns) {
+        columns.assign(options.columns, options.columns + options.columnCount);
+        for (unsigned col : columns) {
+            if (col >= nCols)
+                C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter,
+                               "Column index %u is out of range", col);
+        }
+    } else {
+        for (unsigned col = 0; col < nCols; ++col)
+            columns.push_back(col);
+    }
+    bool lines = (options.format == kCBLResultJSONLines);
+    bool pretty = options.pretty && !lines;
+    size_t chunkSize = options.chunkSize ? options.chunkSize : 16384;
+
+    // The results are encoded into one JSONEncoder, which is only finished when a chunk is
+    // written. Pretty-printed chunks after the first start inside the top-level array.
+    JSONEncoder enc;
+    string prettyChunk; // Reused for every pretty-printed chunk
+    int depth = 0;      // Nesting depth at the start of the next chunk
+    auto flush = [&] {
+        if (enc.bytesWritten() == 0)
+            return;
+        alloc_slice json = enc.finish();
+        if (!json)
+            C4Error::raise(FleeceDomain, enc.error(), "%s", enc.errorMessage());
+        enc.reset();
+        slice out = json;
+        if (pretty) {
+            prettyChunk.clear();
+            appendPrettyJSON(prettyChunk, json, depth);
+            out = slice(prettyChunk);
+        }
+        depth = 1;
+        if (!callback(context, out))
+            C4Error::raise(POSIXDomain, ECANCELED, "JSON writing was stopped by the callback");
+    };
+
+    bool first = true;
+    if (!lines)
+        enc.writeRaw("["_sl);
+    while (next()) {
+        if (!first && !lines)
+            enc.writeRaw(","_sl);
+        enc.beginDict(columns.size());
+        for (unsigned col : columns) {
+            if (Value val = column(col); val) {
+                enc.writeKey(_query->columnName(col));
+                enc.writeValue(val);
+            }
+        }
+        enc.endDict();
+        if (lines)
+            enc.writeRaw("\n"_sl);
+        first = false;
+        if (enc.bytesWritten() >= chunkSize)
+            flush();
+    }
+    if (!lines)
+        enc.writeRaw("]"_sl);
+    flush();
+}
+
+
+alloc_slice CBLResultSet::continuationToken() const {
+    if (!_query->isKeysetQuery())
+        C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter,
+                       "The query wasn't created by CBLDatabase_CreateKeysetQuery");
+    if (!_hasRow)
+        C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter,
+                       "The result set isn't positioned on a result");
+    unsigned nCols = _query->columnCount();
+    JSONEncoder enc;
+    enc.beginArray();
+    enc.writeValue(column(nCols - 2));      // Sort key
+    enc.writeValue(column(nCols - 1));      // Document ID
+    enc.endArray();
+    return enc.finish();
+}
+
+
 Retained<CBLResultSet> CBLResultSet::containing(Value v) {
     return (CBLResultSet*) Doc::containing(v).associated("CBLResultSet");
 }
@@ -136,10 +442,12 @@ CBLBlob* CBLResultSet::getBlob(Dict blobDict, const C4BlobKey &key) {
     // (It's not really necessary to cache the CBLBlobs -- they're lightweight objects --
     // but otherwise we'd have to return a `Retained<CBLBlob>`, which would complicate
     // the public C API by making the caller release it afterwards.)
-    auto i = _blobs.find(blobDict);
-    if (i == _blobs.end()) {
+    if (!_blobs)
+        _blobs = make_unique<ValueToBlobMap>();
+    auto i = _blobs->find(blobDict);
+    if (i == _blobs->end()) {
         auto db = const_cast<CBLDatabase*>(query()->database());
-        i = _blobs.emplace(blobDict, new CBLBlob(db, blobDict, key)).first;
+        i = _blobs->emplace(blobDict, new CBLBlob(db, blobDict, key)).first;
     }
     return i->second;
 }
@@ -149,9 +457,11 @@ CBLBlob* CBLResultSet::getBlob(Dict blobDict, const C4BlobKey &key) {
 
 CBLEncryptable* CBLResultSet::getEncryptableValue(Dict encDict) {
     // Find or create a CBLEncryptable, then cache it.
-    auto i = _encryptables.find(encDict);
-    if (i == _encryptables.end()) {
-        i = _encryptables.emplace(encDict, new CBLEncryptable(encDict)).first;
+    if (!_encryptables)
+        _encryptables = make_unique<ValueToEncryptableMap>();
+    auto i = _encryptables->find(encDict);
+    if (i == _encryptables->end()) {
+        i = _encryptables->emplace(encDict, new CBLEncryptable(encDict)).first;
     }
     return i->second;
 }
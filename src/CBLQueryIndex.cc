@@ -42,7 +42,11 @@ slice CBLQueryIndex::name() const {
 #ifdef COUCHBASE_ENTERPRISE
 
 Retained<CBLIndexUpdater> CBLQueryIndex::beginUpdate(size_t limit) {
-    auto updater = _c4Index.useLocked()->beginUpdate(limit);
+    Retained<C4IndexUpdater> updater;
+    {
+        auto timing = collection()->database()->timeLock(LockCategory::Index);
+        updater = _c4Index.useLocked()->beginUpdate(limit);
+    }
     if (!updater) {
         return nullptr;
     }
@@ -114,6 +118,7 @@ void CBLIndexUpdater::finish() {
     
     checkFinishedUnLock();
     
+    auto timing = _db->timeLock(LockCategory::Index);
     auto lock = _db->c4db()->useLocked();
     _c4IndexUpdater->finish(); // Ignore return value
     _c4IndexUpdater = nullptr;
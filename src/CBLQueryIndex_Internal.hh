@@ -38,8 +38,8 @@ public:
 #endif
     
 private:
-    Retained<CBLCollection>                         _collection;
-    litecore::shared_access_lock<Retained<C4Index>> _c4Index;
+    Retained<CBLCollection>                                         _collection;
+    litecore::shared_access_lock<Retained<C4Index>, OptionalMutex>  _c4Index;
 };
 
 #ifdef COUCHBASE_ENTERPRISE
@@ -41,6 +41,35 @@ CBLQuery* CBLDatabase_CreateQuery(const CBLDatabase* db,
     } catchAndBridge(outError)
 }
 
+bool CBLDatabase_SetQueryCacheCapacity(CBLDatabase* db,
+                                       size_t capacity,
+                                       CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        db->setQueryCacheCapacity(capacity);
+        return true;
+    } catchAndBridge(outError)
+}
+
+CBLQueryCacheStats CBLDatabase_GetQueryCacheStats(const CBLDatabase* db) noexcept {
+    return db->queryCacheStats();
+}
+
+CBLQuery* CBLDatabase_CreateKeysetQuery(const CBLDatabase* db,
+                                        const CBLKeysetQueryConfiguration* config,
+                                        FLSlice continuationToken,
+                                        CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        auto query = db->createKeysetQuery(*config, continuationToken);
+        if (!query) {
+            C4Error::set(LiteCoreDomain, kC4ErrorInvalidQuery, {}, internal(outError));
+            return nullptr;
+        }
+        return std::move(query).detach();
+    } catchAndBridge(outError)
+}
+
 FLDict CBLQuery_Parameters(const CBLQuery* query) noexcept {
     return query->parameters();
 }
@@ -55,6 +84,37 @@ CBLResultSet* CBLQuery_Execute(CBLQuery* query, CBLError* outError) noexcept {
     } catchAndBridge(outError)
 }
 
+bool CBLQuery_ExecuteBatch(CBLQuery* query,
+                           FLArray parameterSets,
+                           CBLQueryBatchCallback callback,
+                           void* _cbl_nullable context,
+                           CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        query->executeBatch(parameterSets, callback, context);
+        return true;
+    } catchAndBridge(outError)
+}
+
+CBLQueryTask* CBLQuery_ExecuteAsync(CBLQuery* query,
+                                    unsigned timeoutMS,
+                                    CBLQueryCompletionCallback completion,
+                                    void* _cbl_nullable context,
+                                    CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        return query->executeAsync(timeoutMS, completion, context).detach();
+    } catchAndBridge(outError)
+}
+
+void CBLQueryTask_Cancel(CBLQueryTask* task) noexcept {
+    task->cancel();
+}
+
+void CBLQuery_SetProfilingEnabled(CBLQuery* query, bool enabled) noexcept {
+    query->setProfilingEnabled(enabled);
+}
+
 FLSliceResult CBLQuery_Explain(const CBLQuery* query) noexcept {
     try {
         return FLSliceResult(query->explain());
@@ -69,11 +129,17 @@ FLSlice CBLQuery_ColumnName(const CBLQuery* query, unsigned col) noexcept {
     return query->columnName(col);
 }
 
+int CBLQuery_ColumnIndex(const CBLQuery* query, FLString name) noexcept {
+    return query->columnNamed(name);
+}
+
 CBLListenerToken* CBLQuery_AddChangeListener(CBLQuery* query,
                                              CBLQueryChangeListener listener,
                                              void *context) noexcept
 {
-    return query->addChangeListener(listener, context).detach();
+    try {
+        return query->addChangeListener(listener, context).detach();
+    } catchAndWarn();
 }
 
 CBLResultSet* CBLQuery_CopyCurrentResults(const CBLQuery* query,
@@ -101,6 +167,37 @@ bool CBLResultSet_Next(CBLResultSet* rs) noexcept {
     } catchAndWarn();
 }
 
+unsigned CBLResultSet_NextBatch(CBLResultSet* rs,
+                                unsigned maxRows,
+                                const CBLColumnSpec* columnSpecs,
+                                CBLColumnBuffer* outBuffers,
+                                unsigned columnCount,
+                                CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        return rs->nextBatch(maxRows, columnSpecs, outBuffers, columnCount);
+    } catchAndBridge(outError)
+}
+
+unsigned CBLResultSet_GetColumnValues(const CBLResultSet* rs,
+                                      FLValue outValues[],
+                                      unsigned maxColumns) noexcept
+{
+    return rs->columnValues(outValues, maxColumns);
+}
+
+bool CBLResultSet_WriteJSON(CBLResultSet* rs,
+                            const CBLResultJSONOptions* _cbl_nullable options,
+                            CBLJSONWriteCallback callback,
+                            void* _cbl_nullable context,
+                            CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        rs->writeJSON(options ? *options : CBLResultJSONOptions{}, callback, context);
+        return true;
+    } catchAndBridge(outError)
+}
+
 FLValue CBLResultSet_ValueForKey(const CBLResultSet* rs, FLString property) noexcept {
     return rs->property(property);
 }
@@ -117,6 +214,20 @@ FLDict CBLResultSet_ResultDict(const CBLResultSet *rs) noexcept {
     return rs->asDict();
 }
 
+FLSliceResult CBLResultSet_ContinuationToken(const CBLResultSet* rs,
+                                             CBLError* _cbl_nullable outError) noexcept
+{
+    try {
+        return FLSliceResult(rs->continuationToken());
+    } catchAndBridge(outError)
+}
+
+CBLQueryStats CBLResultSet_Stats(const CBLResultSet* rs) noexcept {
+    try {
+        return rs->stats();
+    } catchAndWarn()
+}
+
 CBLQuery* CBLResultSet_GetQuery(const CBLResultSet *rs) noexcept {
     return rs->query();
 }
@@ -22,16 +22,17 @@
 #include "Internal.hh"
 #include "Listener.hh"
 #include "ContextManager.hh"
+#include "QueryRunner.hh"
 #include "c4Query.hh"
 #include "access_lock.hh"
 #include "fleece/Expert.hh"
 #include "fleece/Fleece.hh"
 #include "fleece/Mutable.hh"
+#include <chrono>
 #include <optional>
 #include <unordered_map>
 
 #ifdef DEBUG
-#include <chrono>
 #include <thread>
 #endif
 
@@ -65,6 +66,7 @@ public:
     }
 
     Dict parameters() const {
+        auto c4query = _c4query.useLocked();    // Guards _parameters
         if (!_parameters)
             return nullptr;
         return ValueFromData(_parameters, kFLTrusted).asDict();
@@ -82,7 +84,38 @@ public:
         _encodeParameters(enc);
     }
 
-    inline Retained<CBLResultSet> execute();
+    Retained<CBLResultSet> execute() {
+        alloc_slice parameters;
+        {
+            auto c4query = _c4query.useLocked();    // Guards _parameters
+            parameters = _parameters;
+        }
+        return executeWith(parameters);
+    }
+
+    void executeBatch(Array parameterSets, CBLQueryBatchCallback callback, void* _cbl_nullable context);
+
+    Retained<CBLQueryTask> executeAsync(unsigned timeoutMS,
+                                        CBLQueryCompletionCallback completion,
+                                        void* _cbl_nullable context);
+
+    /** True if created by `CBLDatabase::createKeysetQuery`, whose last two columns are the sort
+        key and document ID. */
+    bool isKeysetQuery() const          {return _keyset;}
+
+    void setProfilingEnabled(bool enabled)      {_profiling = enabled;}
+    uint64_t compileNS() const                  {return _compileNS;}
+
+    /** The indexes and table scans in the query plan, parsed from `explain()`. */
+    struct PlanInfo {
+        fleece::MutableArray    indexes = fleece::MutableArray::newArray();
+        bool                    fullScan {false};
+    };
+
+    const PlanInfo& planInfo() const {
+        call_once(_oncePlanInfo, [this]{ _planInfo = parsePlan(explain()); });
+        return _planInfo;
+    }
 
     using ColumnNamesMap = std::unordered_map<slice, uint32_t>;
 
@@ -112,22 +145,56 @@ private:
 
     CBLQuery(const CBLDatabase *db,
              Retained<C4Query>&& c4query,
-             const litecore::access_lock<Retained<C4Database>> &owner)
+             const litecore::access_lock<Retained<C4Database>, OptionalMutex> &owner,
+             C4QueryLanguage language,
+             slice queryString,
+             bool sharedC4Query)
     :_c4query(std::move(c4query), owner)
     ,_database(db)
+    ,_language(language)
+    ,_queryString(queryString)
+    ,_sharedC4Query(sharedC4Query)
     { }
 
+    // Replaces a C4Query shared through the database's query cache with one of my own, since a
+    // query observer keeps using the C4Query's parameters after the call that set them returns.
+    void useOwnC4Query() {
+        auto c4query = _c4query.useLocked();
+        if (!_sharedC4Query)
+            return;
+        Retained<C4Query> ownQuery = _database->compileQuery(_language, _queryString, nullptr);
+        if (!ownQuery)
+            C4Error::raise(LiteCoreDomain, kC4ErrorInvalidQuery, "Couldn't recompile the query");
+        ownQuery->setParameters(_parameters);
+        c4query.get() = std::move(ownQuery);
+        _sharedC4Query = false;
+    }
+
+    static PlanInfo parsePlan(slice explanation);
+
+    // Runs the query with the given encoded parameters, which override the C4Query's own.
+    inline Retained<CBLResultSet> executeWith(slice encodedParameters);
+
     void _encodeParameters(Encoder &enc) {
         alloc_slice encodedParameters = enc.finish();
         if (!encodedParameters)
             C4Error::raise(FleeceDomain, enc.error(), "%s", enc.errorMessage());
+        auto c4query = _c4query.useLocked();
         _parameters = encodedParameters;
-        _c4query.useLocked()->setParameters(encodedParameters);
+        c4query->setParameters(encodedParameters);
     }
 
-    litecore::shared_access_lock<Retained<C4Query>> _c4query;           // Thread-safe access to C4Query
+    litecore::shared_access_lock<Retained<C4Query>, OptionalMutex> _c4query; // Thread-safe access to C4Query
     RetainedConst<CBLDatabase>                      _database;          // Owning database
-    alloc_slice                                     _parameters;        // Fleece-encoded param values
+    C4QueryLanguage const                           _language;          // For compiling on readers
+    alloc_slice const                               _queryString;       // For compiling on readers
+    alloc_slice                                     _parameters;        // Fleece-encoded params, under _c4query lock
+    bool                                            _sharedC4Query;     // C4Query is in the query cache
+    bool                                            _keyset {false};    // Created by createKeysetQuery
+    std::atomic<bool>                               _profiling {false}; // Record CBLQueryStats
+    uint64_t                                        _compileNS {0};     // Time taken by newQuery
+    mutable PlanInfo                                _planInfo;          // Parsed lazily
+    mutable std::once_flag                          _oncePlanInfo;      // For lazy init of _planInfo
     mutable std::optional<ColumnNamesMap>           _columnNames;       // Maps colum name to index
     mutable std::once_flag                          _onceColumnNames;   // For lazy init of _columnNames
     Listeners<CBLQueryChangeListener>               _listeners;         // Query listeners
@@ -145,16 +212,44 @@ public:
 
     bool next();
 
+    unsigned nextBatch(unsigned maxRows,
+                       const CBLColumnSpec* columnSpecs,
+                       CBLColumnBuffer* outBuffers,
+                       unsigned columnCount);
+
     Value property(slice prop) const;
 
-    Value column(unsigned col) const    {return _enum.column(col);}
+    unsigned columnValues(FLValue _cbl_nullable outValues[], unsigned maxColumns) const;
+
+    Value column(unsigned col) const {
+        if (_profiling)
+            ++_stats.valuesRead;
+        return _enum.column(col);
+    }
 
     Array asArray() const;
 
     Dict asDict() const;
 
+    void writeJSON(const CBLResultJSONOptions &options,
+                   CBLJSONWriteCallback callback,
+                   void* _cbl_nullable context);
+
     CBLQuery* query() const             {return _query;}
 
+    using clock = std::chrono::steady_clock;
+
+    /** Starts recording stats; called by `CBLQuery::execute()` if profiling is enabled. */
+    void startProfiling(clock::time_point start, bool usedReader);
+
+    CBLQueryStats stats() const;
+
+    static uint64_t elapsedNS(clock::time_point start) {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count();
+    }
+
+    alloc_slice continuationToken() const;
+
     static Retained<CBLResultSet> containing(Value v);
 
     CBLBlob* getBlob(Dict blobDict, const C4BlobKey&);
@@ -174,9 +269,13 @@ private:
     fleece::MutableArray mutable _asArray;      // Column values as a Fleece Array
     fleece::MutableDict  mutable _asDict;       // Column names/values as a Fleece Dict
     Doc                          _fleeceDoc;    // Fleece Doc that owns the column values
-    ValueToBlobMap               _blobs;        // Cached CBLBLobs, keyed by FLDict
+    bool                         _hasRow {false}; // True if positioned on a result
+    bool                         _profiling {false}; // Recording _stats
+    clock::time_point            _startTime;    // When the query started running, if profiling
+    CBLQueryStats mutable        _stats {};     // Stats, if profiling
+    std::unique_ptr<ValueToBlobMap> _blobs;     // Cached CBLBLobs, keyed by FLDict; created on demand
 #ifdef COUCHBASE_ENTERPRISE
-    ValueToEncryptableMap        _encryptables; // Cached CBLEncryptables, keyed by FLDict
+    std::unique_ptr<ValueToEncryptableMap> _encryptables; // Cached CBLEncryptables; created on demand
 #endif
 };
 
@@ -228,7 +327,7 @@ namespace cbl_internal {
         }
 
         void call() {
-            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            std::lock_guard<OptionalMutex> lock(_mutex);
             CBLQueryChangeListener cb = callback();
             if (cb) {
                 cb(_context, _query, this);
@@ -266,14 +365,44 @@ namespace cbl_internal {
 }
 
 
-inline fleece::Retained<CBLResultSet> CBLQuery::execute() {
-    auto qe = _c4query.useLocked()->run();
-    return retained(new CBLResultSet(this, std::move(qe)));
+inline fleece::Retained<CBLResultSet> CBLQuery::executeWith(slice encodedParameters) {
+    std::optional<CBLResultSet::clock::time_point> start;
+    if (_profiling)
+        start = CBLResultSet::clock::now();
+
+    // Run the query on one of the database's readers, if one is idle, so it doesn't need the
+    // database's lock. The results are fully read by `run()`, so they don't depend on the reader:
+    std::optional<C4Query::Enumerator> qe;
+    _database->useReader([&](ReaderPool::Reader &reader) {
+        Retained<C4Query> c4query;
+        try {
+            c4query = reader.query(_language, _queryString);
+        } catch (...) {
+            return false;   // e.g. a collection created after the reader was opened
+        }
+        c4query->setParameters(encodedParameters);
+        qe.emplace(c4query->run());
+        return true;
+    });
+    bool usedReader = qe.has_value();
+    if (!qe) {
+        auto timing = _database->timeLock(LockCategory::Query);
+        auto c4query = _c4query.useLocked();
+        if (_sharedC4Query)
+            c4query->setParameters(_parameters);    // Another CBLQuery may have set its own
+        qe.emplace(c4query->run(encodedParameters));
+    }
+    auto results = retained(new CBLResultSet(this, std::move(*qe)));
+    if (start)
+        results->startProfiling(*start, usedReader);
+    return results;
 }
 
 
 inline fleece::Retained<CBLListenerToken>
 CBLQuery::addChangeListener(CBLQueryChangeListener listener, void* _cbl_nullable context) {
+    _database->checkMultiThreaded("Query change listeners");
+    useOwnC4Query();
     auto token = retained(new ListenerToken<CBLQueryChangeListener>(this, listener, context));
     _listeners.add(token);
     token->setEnabled(true);
@@ -198,6 +198,7 @@ public:
         
         // Create the LiteCore replicator:
         _db = _conf.effectiveDatabase();
+        _db->checkMultiThreaded("Replicators");
         _db->useLocked([&](C4Database *c4db) {
 #ifdef COUCHBASE_ENTERPRISE
             if (_conf.endpoint->otherLocalDB()) {
@@ -0,0 +1,155 @@
+//
+// DocumentCache.hh
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "CBLDocument_Internal.hh"
+#include "Internal.hh"
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+CBL_ASSUME_NONNULL_BEGIN
+
+namespace cbl_internal {
+
+    /**
+     Thread-safe, size-bounded LRU cache of immutable documents keyed by document ID.
+
+     A lookup that misses returns the cache's current generation, which must be passed to `insert()`
+     along with the document that was read from the database. Every invalidation increments the
+     generation, so a document read before a concurrent change can't be inserted after the change
+     has invalidated it.
+
+     The cache doesn't know which documents changed until the collection reads its observer's
+     changes; in between, it's marked stale by `markStale()`, and the collection must call
+     `invalidate()` for each changed document before using the cache again. */
+    class DocumentCache {
+    public:
+        size_t capacity() const {
+            LOCK(_mutex);
+            return _capacity;
+        }
+
+        bool enabled() const                        {return capacity() > 0;}
+
+        /** Sets the maximum number of documents. Zero disables and clears the cache. */
+        void setCapacity(size_t capacity) {
+            LOCK(_mutex);
+            _capacity = capacity;
+            trim();
+        }
+
+        /** Returns the cached document with the given ID, or null, setting `outGeneration`. */
+        RetainedConst<CBLDocument> get(slice docID, uint64_t &outGeneration) {
+            LOCK(_mutex);
+            outGeneration = _generation;
+            auto i = _map.find(docID);
+            if (i == _map.end()) {
+                ++_misses;
+                return nullptr;
+            }
+            ++_hits;
+            _lru.splice(_lru.begin(), _lru, i->second);    // Move to the front
+            return *i->second;
+        }
+
+        /** Adds a document, unless the cache was invalidated since `generation` was returned by `get()`. */
+        void insert(const CBLDocument* doc, uint64_t generation) {
+            LOCK(_mutex);
+            if (generation != _generation || _capacity == 0)
+                return;
+            auto i = _map.find(doc->docID());
+            if (i != _map.end()) {
+                // Another thread inserted the same document:
+                _lru.splice(_lru.begin(), _lru, i->second);
+                return;
+            }
+            _lru.emplace_front(doc);
+            _map.emplace(doc->docID(), _lru.begin());
+            trim();
+        }
+
+        /** Notes that some documents have changed, without knowing which yet. */
+        void markStale() {
+            LOCK(_mutex);
+            ++_generation;
+            _stale = true;
+        }
+
+        bool stale() const {
+            LOCK(_mutex);
+            return _stale;
+        }
+
+        /** Called before invalidating the changed documents reported by the observer. */
+        void clearStale() {
+            LOCK(_mutex);
+            _stale = false;
+        }
+
+        /** Removes a document that has changed. */
+        void invalidate(slice docID) {
+            LOCK(_mutex);
+            ++_generation;
+            auto i = _map.find(docID);
+            if (i != _map.end()) {
+                ++_invalidations;
+                _lru.erase(i->second);
+                _map.erase(i);
+            }
+        }
+
+        CBLDocumentCacheStats stats() const {
+            LOCK(_mutex);
+            CBLDocumentCacheStats stats = {};
+            stats.hits = _hits;
+            stats.misses = _misses;
+            stats.evictions = _evictions;
+            stats.invalidations = _invalidations;
+            stats.count = _map.size();
+            stats.capacity = _capacity;
+            return stats;
+        }
+
+    private:
+        using LRUList = std::list<RetainedConst<CBLDocument>>;
+
+        // Must be called under the mutex:
+        void trim() {
+            while (_map.size() > _capacity) {
+                _map.erase(_lru.back()->docID());
+                _lru.pop_back();
+                ++_evictions;
+            }
+        }
+
+        mutable std::mutex                                  _mutex;
+        size_t                                              _capacity {0};
+        LRUList                                             _lru;           // Most recently used first
+        std::unordered_map<slice, LRUList::iterator>        _map;           // Keys are owned by the docs
+        uint64_t                                            _generation {0};
+        bool                                                _stale {false};
+        uint64_t                                            _hits {0};
+        uint64_t                                            _misses {0};
+        uint64_t                                            _evictions {0};
+        uint64_t                                            _invalidations {0};
+    };
+
+}
+
+CBL_ASSUME_NONNULL_END
@@ -0,0 +1,80 @@
+//
+// DurabilitySyncer.cc
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "DurabilitySyncer.hh"
+#include "CBLDatabase_Internal.hh"
+#include "CBLLog_Internal.hh"
+
+using namespace std;
+
+namespace cbl_internal {
+
+    void DurabilitySyncer::setInterval(chrono::milliseconds interval) {
+        LOCK(_mutex);
+        _interval = interval;
+    }
+
+
+    void DurabilitySyncer::schedule() {
+        LOCK(_mutex);
+        if (_stopping || _deadline)
+            return;
+        _deadline = chrono::steady_clock::now() + _interval;
+        if (!_thread.joinable())
+            _thread = thread([this] { run(); });
+        _cond.notify_all();
+    }
+
+
+    void DurabilitySyncer::stop() {
+        {
+            LOCK(_mutex);
+            _stopping = true;
+            _cond.notify_all();
+        }
+        if (_thread.joinable())
+            _thread.join();
+    }
+
+
+    void DurabilitySyncer::run() {
+        unique_lock<mutex> lock(_mutex);
+        while (true) {
+            _cond.wait(lock, [&] { return _deadline || _stopping; });
+            if (!_deadline)
+                break;
+            _cond.wait_until(lock, *_deadline, [&] { return _stopping; });
+            _deadline.reset();
+
+            lock.unlock();
+            bool synced = true;
+            try {
+                synced = _database->syncToDisk();
+            } catch (...) {
+                C4Error error = C4Error::fromCurrentException();
+                CBL_Log(kCBLLogDomainDatabase, kCBLLogWarning,
+                        "Couldn't sync the database to disk: %s", error.description().c_str());
+            }
+            lock.lock();
+
+            if (!synced && !_stopping)      // A transaction is open; try again later
+                _deadline = chrono::steady_clock::now() + _interval;
+        }
+    }
+
+}
@@ -0,0 +1,69 @@
+//
+// DurabilitySyncer.hh
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "CBLDatabase.h"
+#include "Internal.hh"
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <optional>
+#include <thread>
+
+CBL_ASSUME_NONNULL_BEGIN
+
+namespace cbl_internal {
+
+    /**
+     Syncs the database file to disk on behalf of transactions committed with
+     `kCBLDurabilityDeferred`. Owned by CBLDatabase.
+
+     A background thread, started on demand, performs a single sync for all the transactions
+     committed since the last one, no later than `interval` after the first of them. If a
+     transaction is open at that time, the sync is retried one interval later. */
+    class DurabilitySyncer {
+    public:
+        static constexpr unsigned kDefaultIntervalMS = 50;
+
+        explicit DurabilitySyncer(CBLDatabase* db)  :_database(db) { }
+        ~DurabilitySyncer()                         {stop();}
+
+        void setInterval(std::chrono::milliseconds interval);
+
+        /** Schedules a sync, unless one is already scheduled. */
+        void schedule();
+
+        /** Performs the scheduled sync, if any, then stops the thread. Later calls to
+            `schedule()` are ignored; the database file is synced when it's closed anyway. */
+        void stop();
+
+    private:
+        void run();
+
+        CBLDatabase* const                                      _database;
+        std::mutex                                              _mutex;
+        std::condition_variable                                 _cond;
+        std::thread                                             _thread;
+        std::chrono::milliseconds                               _interval {kDefaultIntervalMS};
+        std::optional<std::chrono::steady_clock::time_point>    _deadline;
+        bool                                                    _stopping {false};
+    };
+
+}
+
+CBL_ASSUME_NONNULL_END
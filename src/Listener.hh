@@ -19,6 +19,7 @@
 #pragma once
 #include "CBLDatabase.h"
 #include "Internal.hh"
+#include "OptionalMutex.hh"
 #include "fleece/InstanceCounted.hh"
 #include <access_lock.hh>
 #include <functional>
@@ -61,6 +62,10 @@ public:
         stopping the underlinging observer and etc before the token is removed. */
     virtual void willRemove() { }
 
+    /** Disables the token's mutex, when it belongs to a single-threaded database.
+        Must be called before the token is visible to any other thread. */
+    void setSingleThreaded()                                {_mutex.setSingleThreaded();}
+
     /** For attaching some extra info. For example, use the extraInfo for keeping a listener
         and its context when wrapping the to pass the listener to another listener. */
     C4ExtraInfo& extraInfo()                                {return _extraInfo;}
@@ -70,14 +75,14 @@ protected:
     friend class cbl_internal::ListenersBase;
 
     void removed() {
-        std::lock_guard<std::recursive_mutex> lock(_mutex);
+        std::lock_guard<cbl_internal::OptionalMutex> lock(_mutex);
         _owner = nullptr;
         _callback = nullptr;
     }
 
     /** Must be held when accessing _callback and while running it.
         https://github.com/couchbase/couchbase-lite-C/pull/372 */
-    std::recursive_mutex                       _mutex;
+    cbl_internal::OptionalMutex                _mutex;
     const void*  _cbl_nullable                 _callback;          // Really a C fn pointer
     void* const  _cbl_nullable                 _context;
     C4ExtraInfo                                _extraInfo = {};
@@ -100,7 +105,7 @@ namespace cbl_internal {
 
         template <class... Args>
         void call(Args... args) {
-            std::lock_guard<std::recursive_mutex> lock(_mutex);
+            std::lock_guard<cbl_internal::OptionalMutex> lock(_mutex);
             LISTENER cb = callback();
             if (cb)
                 cb(_context, args...);
@@ -0,0 +1,155 @@
+//
+// LockStats.hh
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "CBLDatabase.h"
+#include "Internal.hh"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+
+CBL_ASSUME_NONNULL_BEGIN
+
+namespace cbl_internal {
+
+    enum class LockCategory {
+        DocumentRead,
+        DocumentWrite,
+        Query,
+        Index,
+        Observer,
+        Transaction,
+    };
+
+    /**
+     Opt-in statistics of the time spent waiting for, and holding, a database's lock.
+
+     A `LockStats::Scope` acquires the lock itself before the code in its scope calls `useLocked()`,
+     which then re-enters the (recursive) lock without waiting. Only the outermost scope of each
+     LockStats on a thread is recorded, so nested locked calls aren't counted twice, while a scope
+     of another database nested in it still is. When recording is disabled, a scope does nothing. */
+    class LockStats {
+        using clock = std::chrono::steady_clock;
+
+        // A recording Scope, in the current thread's list of them, innermost first:
+        struct ActiveScope {
+            const LockStats* _cbl_nullable  stats;
+            ActiveScope* _cbl_nullable      outer;
+        };
+
+    public:
+        void setEnabled(bool enabled)               {_enabled = enabled;}
+        bool enabled() const                        {return _enabled;}
+
+        CBLLockStats stats() const {
+            LOCK(_mutex);
+            return _stats;
+        }
+
+        void reset() {
+            LOCK(_mutex);
+            _stats = {};
+        }
+
+        template <class MUTEX>
+        class Scope {
+        public:
+            Scope(LockStats &stats, MUTEX &mutex, LockCategory category)
+            :_stats(stats)
+            ,_category(category)
+            {
+                if (!stats.enabled() || stats.activeOnThisThread())
+                    return;
+                _active = {&stats, tActiveScopes};
+                tActiveScopes = &_active;
+                auto start = clock::now();
+                _lock = std::unique_lock<MUTEX>(mutex);
+                _acquired = clock::now();
+                _wait = _acquired - start;
+            }
+
+            ~Scope() {
+                if (!_lock.owns_lock())
+                    return;
+                _lock.unlock();
+                tActiveScopes = _active.outer;
+                _stats.record(_category, _wait, clock::now() - _acquired);
+            }
+
+            Scope(const Scope&) = delete;
+            Scope& operator=(const Scope&) = delete;
+
+        private:
+            LockStats&                  _stats;
+            LockCategory const          _category;
+            ActiveScope                 _active {};
+            std::unique_lock<MUTEX>     _lock;
+            clock::time_point           _acquired;
+            clock::duration             _wait {};
+        };
+
+    private:
+        static inline thread_local ActiveScope* _cbl_nullable tActiveScopes = nullptr;
+
+        bool activeOnThisThread() const {
+            for (auto scope = tActiveScopes; scope; scope = scope->outer) {
+                if (scope->stats == this)
+                    return true;
+            }
+            return false;
+        }
+
+        CBLLockCategoryStats& categoryStats(LockCategory category) {
+            switch (category) {
+                case LockCategory::DocumentRead:    return _stats.documentRead;
+                case LockCategory::DocumentWrite:   return _stats.documentWrite;
+                case LockCategory::Query:           return _stats.query;
+                case LockCategory::Index:           return _stats.index;
+                case LockCategory::Observer:        return _stats.observer;
+                case LockCategory::Transaction:     return _stats.transaction;
+            }
+            return _stats.documentRead;
+        }
+
+        void record(LockCategory category, clock::duration wait, clock::duration hold) {
+            using namespace std::chrono;
+            auto waitNS = uint64_t(duration_cast<nanoseconds>(wait).count());
+            auto holdNS = uint64_t(duration_cast<nanoseconds>(hold).count());
+            size_t bucket = 0;
+            for (uint64_t limit = 10000; bucket < 5 && holdNS >= limit; limit *= 10)
+                ++bucket;
+
+            LOCK(_mutex);
+            CBLLockCategoryStats &s = categoryStats(category);
+            ++s.acquisitions;
+            s.totalWaitNS += waitNS;
+            s.maxWaitNS = std::max(s.maxWaitNS, waitNS);
+            s.totalHoldNS += holdNS;
+            s.maxHoldNS = std::max(s.maxHoldNS, holdNS);
+            ++s.holdHistogram[bucket];
+        }
+
+        std::atomic<bool>       _enabled {false};
+        mutable std::mutex      _mutex;
+        CBLLockStats            _stats {};
+    };
+
+}
+
+CBL_ASSUME_NONNULL_END
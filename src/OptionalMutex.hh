@@ -0,0 +1,86 @@
+//
+// OptionalMutex.hh
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "access_lock.hh"
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include "betterassert.hh"
+
+namespace cbl_internal {
+
+    /**
+     A recursive mutex that can be turned into a no-op, for objects belonging to a database that was
+     opened with `CBLDatabaseConfiguration.singleThreaded`.
+
+     Single-threaded mode must be set before the object is visible to any other thread, and can't be
+     turned off. In debug builds a single-threaded mutex remembers the first thread that locks it,
+     and asserts that no other thread ever does. */
+    class OptionalMutex {
+    public:
+        void setSingleThreaded()                    {_singleThreaded = true;}
+        bool isSingleThreaded() const               {return _singleThreaded;}
+
+        void lock() {
+            if (_singleThreaded)
+                checkThread();
+            else
+                _mutex.lock();
+        }
+
+        bool try_lock() {
+            if (_singleThreaded) {
+                checkThread();
+                return true;
+            }
+            return _mutex.try_lock();
+        }
+
+        void unlock() {
+            if (!_singleThreaded)
+                _mutex.unlock();
+        }
+
+    private:
+        void checkThread() {
+#ifdef DEBUG
+            std::thread::id none, current = std::this_thread::get_id();
+            if (!_owner.compare_exchange_strong(none, current))
+                assert(none == current);    // Single-threaded database used by more than one thread!
+#endif
+        }
+
+        std::recursive_mutex                _mutex;
+        bool                                _singleThreaded {false};
+#ifdef DEBUG
+        std::atomic<std::thread::id>        _owner {};
+#endif
+    };
+
+
+    /** An access_lock whose mutex is an OptionalMutex. */
+    template <class T>
+    class optional_access_lock : public litecore::access_lock<T, OptionalMutex> {
+    public:
+        using litecore::access_lock<T, OptionalMutex>::access_lock;
+
+        void setSingleThreaded()                    {this->getMutex().setSingleThreaded();}
+    };
+
+}
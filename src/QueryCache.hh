@@ -0,0 +1,120 @@
+//
+// QueryCache.hh
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "CBLQuery.h"
+#include "c4Query.hh"
+#include "Internal.hh"
+#include <list>
+#include <string>
+#include <unordered_map>
+
+CBL_ASSUME_NONNULL_BEGIN
+
+namespace cbl_internal {
+
+    /**
+     Size-bounded LRU cache of compiled queries keyed by query language and text.
+
+     A cached C4Query is shared by every CBLQuery created from the same text, so it must only be
+     used under the database's lock. The cache itself isn't thread-safe either: every call must be
+     made under the database's lock, which also ensures that an evicted C4Query is destroyed
+     under it. */
+    class QueryCache {
+    public:
+        size_t capacity() const                     {return _capacity;}
+
+        /** Sets the maximum number of queries. Zero disables and clears the cache. */
+        void setCapacity(size_t capacity) {
+            _capacity = capacity;
+            trim();
+        }
+
+        /** Returns the cached query compiled from the given text, or null. */
+        Retained<C4Query> get(C4QueryLanguage language, slice queryString) {
+            if (_capacity == 0)
+                return nullptr;
+            auto i = _map.find(key(language, queryString));
+            if (i == _map.end()) {
+                ++_misses;
+                return nullptr;
+            }
+            ++_hits;
+            _lru.splice(_lru.begin(), _lru, i->second);    // Move to the front
+            return i->second->query;
+        }
+
+        /** Adds a newly compiled query. Returns true if it was cached, and so may be shared. */
+        bool insert(C4QueryLanguage language, slice queryString, C4Query* query) {
+            if (_capacity == 0)
+                return false;
+            std::string k = key(language, queryString);
+            if (_map.find(k) != _map.end())
+                return false;
+            _lru.push_front({k, query});
+            _map.emplace(std::move(k), _lru.begin());
+            trim();
+            return true;
+        }
+
+        /** Removes every query, e.g. because the indexes or collections they use have changed. */
+        void clear() {
+            _map.clear();
+            _lru.clear();
+        }
+
+        CBLQueryCacheStats stats() const {
+            CBLQueryCacheStats stats = {};
+            stats.hits = _hits;
+            stats.misses = _misses;
+            stats.evictions = _evictions;
+            stats.count = _map.size();
+            stats.capacity = _capacity;
+            return stats;
+        }
+
+    private:
+        struct Entry {
+            std::string         key;
+            Retained<C4Query>   query;
+        };
+        using LRUList = std::list<Entry>;
+
+        static std::string key(C4QueryLanguage language, slice queryString) {
+            return std::to_string(language) + ":" + std::string(queryString);
+        }
+
+        void trim() {
+            while (_map.size() > _capacity) {
+                _map.erase(_lru.back().key);
+                _lru.pop_back();
+                ++_evictions;
+            }
+        }
+
+        size_t                                              _capacity {0};
+        LRUList                                             _lru;           // Most recently used first
+        std::unordered_map<std::string, LRUList::iterator>  _map;
+        uint64_t                                            _hits {0};
+        uint64_t                                            _misses {0};
+        uint64_t                                            _evictions {0};
+    };
+
+}
+
+CBL_ASSUME_NONNULL_END
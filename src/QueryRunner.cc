@@ -0,0 +1,204 @@
+//
+// QueryRunner.cc
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "QueryRunner.hh"
+#include "CBLDatabase_Internal.hh"
+#include "CBLQuery_Internal.hh"
+#include <algorithm>
+#include <cerrno>
+
+using namespace std;
+using namespace fleece;
+
+
+#pragma mark - TASK:
+
+
+CBLQueryTask::CBLQueryTask(CBLQuery* query,
+                           clock::time_point deadline,
+                           CBLQueryCompletionCallback completion,
+                           void* _cbl_nullable context)
+:_query(query)
+,_deadline(deadline)
+,_completion(completion)
+,_context(context)
+{ }
+
+
+void CBLQueryTask::cancel() {
+    finish(nullptr, C4Error{POSIXDomain, ECANCELED});
+}
+
+
+void CBLQueryTask::timeOut() {
+    finish(nullptr, C4Error{POSIXDomain, ETIMEDOUT});
+}
+
+
+void CBLQueryTask::run() {
+    if (_done)
+        return;
+    if (clock::now() >= _deadline) {
+        timeOut();
+        return;
+    }
+    Retained<CBLResultSet> results;
+    C4Error error {};
+    try {
+        results = _query->execute();
+    } catch (...) {
+        error = C4Error::fromCurrentException();
+    }
+    finish(results, error);
+}
+
+
+void CBLQueryTask::finish(CBLResultSet* _cbl_nullable results, C4Error error) {
+    if (_done.exchange(true))
+        return;     // Already finished; discard the results
+    auto completion = _completion;
+    auto context = _context;
+    Retained<CBLResultSet> retainedResults = results;
+    CBLError cblError = external(error);
+    _query->database()->notify([=]() {
+        completion(context, retainedResults, cblError);
+    });
+}
+
+
+#pragma mark - RUNNER:
+
+
+namespace cbl_internal {
+
+    // The threads retain this object, so they have already exited by now.
+    QueryRunner::~QueryRunner() = default;
+
+
+    void QueryRunner::enqueue(CBLQueryTask* task) {
+        LOCK(_mutex);
+        if (_stopping)
+            C4Error::raise(LiteCoreDomain, kC4ErrorNotOpen, "Database is closed or deleted");
+        _queue.push_back(task);
+        if (_idleWorkers == 0 && _workers.size() < kMaxWorkers) {
+            Retained<QueryRunner> retainedSelf = this;
+            _workers.emplace_back([retainedSelf] { retainedSelf->runWorker(); });
+        }
+        _cond.notify_one();
+
+        if (task->deadline() != CBLQueryTask::clock::time_point::max()) {
+            _timed.push_back(task);
+            if (!_watchdog.joinable()) {
+                Retained<QueryRunner> retainedSelf = this;
+                _watchdog = thread([retainedSelf] { retainedSelf->runWatchdog(); });
+            }
+            _watchdogCond.notify_one();
+        }
+    }
+
+
+    void QueryRunner::stop() {
+        deque<Retained<CBLQueryTask>> queued;
+        vector<Retained<CBLQueryTask>> timed;
+        vector<thread> threads;
+        {
+            LOCK(_mutex);
+            if (_stopping)
+                return;
+            _stopping = true;
+            queued = std::move(_queue);
+            _queue.clear();
+            timed = std::move(_timed);
+            _timed.clear();
+            threads = std::move(_workers);
+            if (_watchdog.joinable())
+                threads.push_back(std::move(_watchdog));
+            _cond.notify_all();
+            _watchdogCond.notify_all();
+        }
+        for (auto &task : queued)
+            task->cancel();
+        queued.clear();
+        timed.clear();
+        for (auto &t : threads) {
+            if (t.get_id() == this_thread::get_id())
+                t.detach();     // Called from a completion callback
+            else
+                t.join();
+        }
+    }
+
+
+    void QueryRunner::runWorker() {
+        unique_lock<mutex> lock(_mutex);
+        while (true) {
+            ++_idleWorkers;
+            _cond.wait(lock, [&] { return !_queue.empty() || _stopping; });
+            --_idleWorkers;
+            if (_queue.empty())
+                break;
+            Retained<CBLQueryTask> task = std::move(_queue.front());
+            _queue.pop_front();
+
+            lock.unlock();
+            task->run();
+            bool timed = (task->deadline() != CBLQueryTask::clock::time_point::max());
+            task = nullptr;     // May release the last reference to the database
+            lock.lock();
+            if (timed)
+                _watchdogCond.notify_one();     // Let the watchdog release the finished task
+        }
+    }
+
+
+    void QueryRunner::runWatchdog() {
+        using clock = CBLQueryTask::clock;
+        unique_lock<mutex> lock(_mutex);
+        while (!_stopping) {
+            auto now = clock::now();
+            auto next = clock::time_point::max();
+            vector<Retained<CBLQueryTask>> expired, finished;
+            for (auto &task : _timed) {
+                if (task->isDone())
+                    finished.push_back(std::move(task));
+                else if (task->deadline() <= now)
+                    expired.push_back(std::move(task));
+                else
+                    next = min(next, task->deadline());
+            }
+            _timed.erase(remove_if(_timed.begin(), _timed.end(), [](auto &task) {return !task;}),
+                         _timed.end());
+
+            if (!expired.empty() || !finished.empty()) {
+                // Releasing a task may release the last reference to the database, whose
+                // destructor stops this runner, so don't hold the mutex:
+                lock.unlock();
+                for (auto &task : expired)
+                    task->timeOut();
+                expired.clear();
+                finished.clear();
+                lock.lock();
+            } else if (next == clock::time_point::max()) {
+                _watchdogCond.wait(lock);
+            } else {
+                _watchdogCond.wait_until(lock, next);
+            }
+        }
+    }
+
+}
@@ -0,0 +1,109 @@
+//
+// QueryRunner.hh
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "CBLQuery.h"
+#include "Internal.hh"
+#include "fleece/RefCounted.hh"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+CBL_ASSUME_NONNULL_BEGIN
+
+
+/** An asynchronous execution of a query, returned by `CBLQuery_ExecuteAsync`. It finishes exactly
+    once: when the query has run, or when it's canceled or its deadline passes, whichever is first. */
+struct CBLQueryTask final : public CBLRefCounted {
+public:
+    using clock = std::chrono::steady_clock;
+
+    CBLQueryTask(CBLQuery* query,
+                 clock::time_point deadline,
+                 CBLQueryCompletionCallback completion,
+                 void* _cbl_nullable context);
+
+    clock::time_point deadline() const          {return _deadline;}
+    bool isDone() const                         {return _done;}
+
+    void cancel();
+
+    /** Runs the query, unless the task has already finished. Called on a worker thread. */
+    void run();
+
+    /** Finishes the task with a timeout error, unless it has already finished. */
+    void timeOut();
+
+private:
+    void finish(CBLResultSet* _cbl_nullable results, C4Error error);
+
+    Retained<CBLQuery> const                    _query;         // Also keeps the database open
+    clock::time_point const                     _deadline;      // time_point::max() if none
+    CBLQueryCompletionCallback const            _completion;
+    void* _cbl_nullable const                   _context;
+    std::atomic<bool>                           _done {false};
+};
+
+
+namespace cbl_internal {
+
+    /**
+     Pool of worker threads that run asynchronous queries. Owned by CBLDatabase.
+
+     Workers are started on demand, up to `kMaxWorkers`. A watchdog thread, started when the first
+     query with a deadline is queued, finishes the tasks whose deadline passes with a timeout error.
+     LiteCore has no way to interrupt a running query, so a query that has started runs to the end
+     on its worker, and its results are discarded if the task was canceled or timed out meanwhile.
+     The threads retain the QueryRunner, so that it can outlive the database. */
+    class QueryRunner : public fleece::RefCounted {
+    public:
+        static constexpr unsigned kMaxWorkers = 4;
+
+        QueryRunner() = default;
+
+        /** Queues a task. Throws NotOpen if the runner has been stopped. */
+        void enqueue(CBLQueryTask* task);
+
+        /** Cancels the queued tasks, waits for the running ones, and stops the threads. */
+        void stop();
+
+    protected:
+        ~QueryRunner();
+
+    private:
+        void runWorker();
+        void runWatchdog();
+
+        std::mutex                                  _mutex;
+        std::condition_variable                     _cond;          // Signals workers
+        std::condition_variable                     _watchdogCond;  // Signals the watchdog
+        std::deque<Retained<CBLQueryTask>>          _queue;         // Tasks waiting for a worker
+        std::vector<Retained<CBLQueryTask>>         _timed;         // Unfinished tasks with deadlines
+        std::vector<std::thread>                    _workers;
+        std::thread                                 _watchdog;
+        unsigned                                    _idleWorkers {0};
+        bool                                        _stopping {false};
+    };
+
+}
+
+CBL_ASSUME_NONNULL_END
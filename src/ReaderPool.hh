@@ -0,0 +1,163 @@
+//
+// ReaderPool.hh
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "CBLLog_Internal.hh"
+#include "c4Database.hh"
+#include "c4Query.hh"
+#include "Defer.hh"
+#include "Internal.hh"
+#include "QueryCache.hh"
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+CBL_ASSUME_NONNULL_BEGIN
+
+namespace cbl_internal {
+
+    /**
+     Pool of read-only C4Databases opened on the same file as a CBLDatabase's own C4Database.
+     Each reader is used by one thread at a time, without the database's lock, so reads can run
+     concurrently with each other and with a write on the primary C4Database. (SQLite's WAL mode
+     gives every read a consistent snapshot of the last committed transaction.)
+
+     `use()` never blocks waiting for a reader: if they're all busy, or the pool is disabled, it
+     returns false and the caller reads from the primary C4Database as usual. */
+    class ReaderPool {
+    public:
+        struct Reader {
+            static constexpr size_t kMaxQueries = 50;
+
+            Retained<C4Database> db;
+
+            Reader()                                {_queries.setCapacity(kMaxQueries);}
+
+            /** Returns this reader's compiled instance of a query, compiling it on first use.
+                Only the most recently used `kMaxQueries` queries are kept. */
+            Retained<C4Query> query(C4QueryLanguage language, slice queryString) {
+                Retained<C4Query> c4query = _queries.get(language, queryString);
+                if (!c4query) {
+                    c4query = db->newQuery(language, queryString);
+                    _queries.insert(language, queryString, c4query);
+                }
+                return c4query;
+            }
+
+        private:
+            friend class ReaderPool;
+            QueryCache _queries;    // Only used by the thread using the reader
+        };
+
+        ~ReaderPool() {
+            close();
+        }
+
+        unsigned size() const {
+            LOCK(_mutex);
+            return unsigned(_readers.size());
+        }
+
+        /** Closes the current readers, once they're idle, and opens `size` new ones. */
+        void resize(slice name, const C4DatabaseConfig2 &primaryConfig, unsigned size) {
+            std::unique_lock<std::mutex> lock(_mutex);
+            if (_closed)
+                C4Error::raise(LiteCoreDomain, kC4ErrorNotOpen, "Database is closed or deleted");
+            drain(lock);
+
+            C4DatabaseConfig2 config = primaryConfig;
+            config.flags = (config.flags & ~kC4DB_Create) | kC4DB_ReadOnly;
+            try {
+                for (unsigned i = 0; i < size; ++i) {
+                    auto reader = std::make_unique<Reader>();
+                    reader->db = C4Database::openNamed(name, config);
+                    _idle.push_back(reader.get());
+                    _readers.push_back(std::move(reader));
+                }
+            } catch (...) {
+                closeReaders();
+                throw;
+            }
+        }
+
+        /** Closes the readers, once they're idle. Called when the database closes. */
+        void close() {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _closed = true;
+            drain(lock);
+        }
+
+        /** Calls `callback(Reader&)` with an idle reader. The callback returns false if it can't
+            perform the read, e.g. because the reader doesn't have a collection that was created
+            after it was opened. Returns false if the callback wasn't called or returned false. */
+        template <class CALLBACK>
+        bool use(CALLBACK callback) {
+            Reader* reader;
+            {
+                LOCK(_mutex);
+                if (_idle.empty() || _draining)
+                    return false;
+                reader = _idle.back();
+                _idle.pop_back();
+            }
+            DEFER {
+                LOCK(_mutex);
+                _idle.push_back(reader);
+                _cond.notify_all();
+            };
+            return callback(*reader);
+        }
+
+    private:
+        // Must be called under the mutex:
+        void drain(std::unique_lock<std::mutex> &lock) {
+            _draining = true;
+            _cond.wait(lock, [&] { return _idle.size() == _readers.size(); });
+            closeReaders();
+            _draining = false;
+        }
+
+        // Must be called under the mutex, when all the readers are idle:
+        void closeReaders() {
+            for (auto &reader : _readers) {
+                reader->_queries.clear();
+                try {
+                    reader->db->close();
+                } catch (...) {
+                    C4Error error = C4Error::fromCurrentException();
+                    CBL_Log(kCBLLogDomainDatabase, kCBLLogWarning,
+                            "Couldn't close a reader database: %s", error.description().c_str());
+                }
+            }
+            _readers.clear();
+            _idle.clear();
+        }
+
+        mutable std::mutex                          _mutex;
+        std::condition_variable                     _cond;
+        std::vector<std::unique_ptr<Reader>>        _readers;
+        std::vector<Reader*>                        _idle;
+        bool                                        _draining {false};
+        bool                                        _closed {false};
+    };
+
+}
+
+CBL_ASSUME_NONNULL_END
@@ -0,0 +1,214 @@
+//
+// WriteQueue.cc
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#include "WriteQueue.hh"
+#include "CBLCollection_Internal.hh"
+#include "CBLDatabase_Internal.hh"
+#include "CBLDocument_Internal.hh"
+#include <algorithm>
+
+using namespace std;
+using namespace fleece;
+
+namespace cbl_internal {
+
+    // The writer thread retains this object, so it has already exited by now.
+    WriteQueue::~WriteQueue() = default;
+
+
+    void WriteQueue::setOptions(const CBLWriteQueueOptions &options) {
+        if (options.maxBatchSize == 0)
+            C4Error::raise(LiteCoreDomain, kC4ErrorInvalidParameter, "maxBatchSize must be greater than zero");
+        LOCK(_mutex);
+        _maxBatchSize = options.maxBatchSize;
+        _maxLatency = chrono::milliseconds(options.maxLatencyMS);
+        _cond.notify_all();
+    }
+
+
+    void WriteQueue::enqueue(CBLCollection* collection,
+                             CBLDocument* doc,
+                             CBLConcurrencyControl concurrency,
+                             CBLSaveCompletionCallback completion,
+                             void* context)
+    {
+        // Report the errors that don't depend on the database's state right away:
+        _database->checkMultiThreaded("Asynchronous saves");
+        doc->checkMutable();
+        CBLDocument::checkCollectionMatches(doc->_collection, collection);
+
+        LOCK(_mutex);
+        if (_stopping)
+            C4Error::raise(LiteCoreDomain, kC4ErrorNotOpen, "Database is closed or deleted");
+        _queue.push_back({_database, collection, doc, concurrency, completion, context});
+        ++_enqueuedCount;
+        if (!_thread.joinable()) {
+            Retained<WriteQueue> retainedSelf = this;
+            _thread = thread([retainedSelf] { retainedSelf->run(); });
+        }
+        _cond.notify_all();
+    }
+
+
+    void WriteQueue::flush() {
+        // The writer doesn't commit while a transaction is open, so waiting could deadlock:
+        if (_database->_transactionDepth > 0)
+            C4Error::raise(LiteCoreDomain, kC4ErrorTransactionNotClosed,
+                           "Can't flush the write queue while a transaction is open");
+        unique_lock<mutex> lock(_mutex);
+        if (_thread.get_id() == this_thread::get_id())
+            return;    // Called from a completion callback; waiting would deadlock
+        uint64_t target = _enqueuedCount;
+        ++_flushers;
+        _cond.notify_all();
+        _cond.wait(lock, [&] { return _committedCount >= target; });
+        --_flushers;
+    }
+
+
+    void WriteQueue::stop() {
+        thread writer;
+        {
+            LOCK(_mutex);
+            if (_stopping)
+                return;
+            _stopping = true;
+            _cond.notify_all();
+            writer = std::move(_thread);
+        }
+        if (writer.joinable()) {
+            if (writer.get_id() == this_thread::get_id())
+                writer.detach();    // Called from a completion callback
+            else
+                writer.join();
+        }
+    }
+
+
+    void WriteQueue::transactionEnded() {
+        LOCK(_mutex);
+        _cond.notify_all();
+    }
+
+
+    void WriteQueue::run() {
+        unique_lock<mutex> lock(_mutex);
+        while (true) {
+            _cond.wait(lock, [&] { return !_queue.empty() || _stopping; });
+            if (_queue.empty())
+                break;
+
+            // Give other threads a chance to add saves to the batch:
+            auto deadline = chrono::steady_clock::now() + _maxLatency;
+            _cond.wait_until(lock, deadline, [&] {
+                return _queue.size() >= _maxBatchSize || _stopping || _flushers > 0;
+            });
+
+            // A batch committed inside an explicit transaction would be rolled back with it:
+            _cond.wait(lock, [&] { return _database->_transactionDepth == 0 || _stopping; });
+
+            size_t count = min(_queue.size(), _maxBatchSize);
+            vector<Request> batch(make_move_iterator(_queue.begin()),
+                                  make_move_iterator(_queue.begin() + count));
+            _queue.erase(_queue.begin(), _queue.begin() + count);
+            bool stopping = _stopping;
+
+            lock.unlock();
+            bool committed = commitBatch(batch, stopping);
+            if (committed)
+                batch.clear();      // May release the last reference to the database
+            lock.lock();
+
+            if (!committed) {
+                // A transaction began before the batch got the lock; wait for it to end:
+                _queue.insert(_queue.begin(), make_move_iterator(batch.begin()),
+                              make_move_iterator(batch.end()));
+                continue;
+            }
+            _committedCount += count;
+            _cond.notify_all();
+        }
+    }
+
+
+    // Returns false, without saving anything, if an explicit transaction is open and the queue
+    // isn't stopping; if it is, the saves fail instead.
+    bool WriteQueue::commitBatch(vector<Request> &batch, bool stopping) {
+        size_t count = batch.size();
+        vector<Retained<C4Document>> newDocs(count);
+        vector<C4Error> errors(count);
+
+        // Note: shared lock b/w database and collections
+        try {
+            auto timing = _database->timeLock(LockCategory::DocumentWrite);
+            bool inTransaction = _database->useLocked<bool>([&](Retained<C4Database> &c4db) {
+                if (_database->_transactionDepth > 0) {
+                    if (!stopping)
+                        return true;
+                    C4Error::raise(LiteCoreDomain, kC4ErrorTransactionNotClosed,
+                                   "Database closed while a transaction is open");
+                }
+                // Each save succeeds or fails on its own; a failed one doesn't abort the others:
+                C4Database::Transaction t(c4db);
+                for (size_t i = 0; i < count; ++i) {
+                    Request &rq = batch[i];
+                    try {
+                        rq.collection->useLocked([&](C4Collection* c4col) {
+                            newDocs[i] = rq.doc->saveRevision(rq.collection, c4col, rq.concurrency);
+                        });
+                        if (!newDocs[i])
+                            errors[i] = C4Error{LiteCoreDomain, kC4ErrorConflict};
+                    } catch (...) {
+                        errors[i] = C4Error::fromCurrentException();
+                    }
+                }
+                t.commit();
+                return false;
+            });
+            if (inTransaction)
+                return false;
+        } catch (...) {
+            // The transaction failed, so none of the documents were saved:
+            C4Error error = C4Error::fromCurrentException();
+            for (size_t i = 0; i < count; ++i) {
+                newDocs[i] = nullptr;
+                if (errors[i].code == 0)
+                    errors[i] = error;
+            }
+        }
+
+        // Only install the new revisions once the transaction has been committed:
+        for (size_t i = 0; i < count; ++i) {
+            Request &rq = batch[i];
+            bool saved = (newDocs[i] != nullptr);
+            if (saved)
+                rq.doc->installRevision(rq.collection, std::move(newDocs[i]));
+            if (rq.completion) {
+                auto completion = rq.completion;
+                auto context = rq.context;
+                Retained<CBLDocument> doc = rq.doc;
+                CBLError error = external(errors[i]);
+                _database->notify([=]() {
+                    completion(context, doc, saved, error);
+                });
+            }
+        }
+        return true;
+    }
+
+}
@@ -0,0 +1,99 @@
+//
+// WriteQueue.hh
+//
+// Copyright © 2024 Couchbase. All rights reserved.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+
+#pragma once
+#include "CBLCollection.h"
+#include "CBLDatabase.h"
+#include "Internal.hh"
+#include "fleece/RefCounted.hh"
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+CBL_ASSUME_NONNULL_BEGIN
+
+namespace cbl_internal {
+
+    /**
+     Group-commit queue of asynchronous document saves. Owned by CBLDatabase.
+
+     Saves can be queued by any thread. A writer thread, started on demand, commits them in
+     batches, each in a single transaction, then invokes their completion callbacks via the
+     database's notification queue. It waits for any explicit transaction to end first, since a
+     batch committed inside one would be rolled back along with it. The thread retains the WriteQueue, so that it can outlive the
+     database when the last reference to the database is released by a completed batch. */
+    class WriteQueue : public fleece::RefCounted {
+    public:
+        static constexpr unsigned kDefaultMaxBatchSize = 100;
+        static constexpr unsigned kDefaultMaxLatencyMS = 10;
+
+        explicit WriteQueue(CBLDatabase* db)        :_database(db) { }
+
+        void setOptions(const CBLWriteQueueOptions &options);
+
+        /** Queues a save. Throws NotOpen if the queue has been stopped. */
+        void enqueue(CBLCollection* collection,
+                     CBLDocument* doc,
+                     CBLConcurrencyControl concurrency,
+                     CBLSaveCompletionCallback _cbl_nullable completion,
+                     void* _cbl_nullable context);
+
+        /** Blocks until every save queued before the call has been committed. */
+        void flush();
+
+        /** Commits the pending saves, then stops the writer thread. Later saves will fail. */
+        void stop();
+
+        /** Called by the database when its outermost explicit transaction ends. */
+        void transactionEnded();
+
+    protected:
+        ~WriteQueue();
+
+    private:
+        struct Request {
+            Retained<CBLDatabase>                   database;   // Keeps the database open until committed
+            Retained<CBLCollection>                 collection;
+            Retained<CBLDocument>                   doc;
+            CBLConcurrencyControl                   concurrency;
+            CBLSaveCompletionCallback _cbl_nullable completion;
+            void* _cbl_nullable                     context;
+        };
+
+        void run();
+        bool commitBatch(std::vector<Request> &batch, bool stopping);
+
+        CBLDatabase* const                          _database;      // Not retained
+        std::mutex                                  _mutex;
+        std::condition_variable                     _cond;
+        std::deque<Request>                         _queue;
+        std::thread                                 _thread;
+        size_t                                      _maxBatchSize {kDefaultMaxBatchSize};
+        std::chrono::milliseconds                   _maxLatency {kDefaultMaxLatencyMS};
+        uint64_t                                    _enqueuedCount {0};
+        uint64_t                                    _committedCount {0};
+        unsigned                                    _flushers {0};
+        bool                                        _stopping {false};
+    };
+
+}
+
+CBL_ASSUME_NONNULL_END
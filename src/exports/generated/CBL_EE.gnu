@@ -138,7 +138,16 @@ CBL_C {
 		CBLDatabase_Delete;
 		CBLDatabase_BeginTransaction;
 		CBLDatabase_EndTransaction;
+		CBLDatabase_EndTransactionWithDurability;
+		CBLDatabase_SetDeferredDurabilityInterval;
 		CBLDatabase_PerformMaintenance;
+		CBLDatabase_SetReaderPoolSize;
+		CBLDatabase_ReaderPoolSize;
+		CBLDatabase_SetLockStatsEnabled;
+		CBLDatabase_GetLockStats;
+		CBLDatabase_ResetLockStats;
+		CBLDatabase_SetWriteQueueOptions;
+		CBLDatabase_FlushWriteQueue;
 		CBLDatabase_BufferNotifications;
 		CBLDatabase_SendNotifications;
 		CBLDatabase_Collection;
@@ -155,17 +164,42 @@ CBL_C {
 		CBLCollection_FullName;
 		CBLCollection_Database;
 		CBLCollection_Count;
+		CBLCollection_LastDurableSequence;
 		CBLCollection_GetDocument;
+		CBLCollection_GetDocuments;
+		CBLCollection_ReadDocument;
 		CBLCollection_SaveDocument;
 		CBLCollection_SaveDocumentWithConcurrencyControl;
 		CBLCollection_SaveDocumentWithConflictHandler;
+		CBLCollection_SaveDocuments;
+		CBLCollection_SaveDocumentAsync;
+		CBLCollection_PatchDocument;
+		CBLCollection_PatchDocumentWithJSON;
 		CBLCollection_DeleteDocument;
 		CBLCollection_DeleteDocumentWithConcurrencyControl;
 		CBLCollection_PurgeDocument;
 		CBLCollection_PurgeDocumentByID;
+		CBLCollection_DeleteDocuments;
+		CBLCollection_PurgeDocuments;
 		CBLCollection_GetDocumentExpiration;
 		CBLCollection_SetDocumentExpiration;
 		CBLCollection_GetMutableDocument;
+		CBLCollection_SetDocumentCacheCapacity;
+		CBLCollection_GetDocumentCacheStats;
+		CBLCollection_ImportJSONLines;
+		CBLCollection_ImportJSONLinesFile;
+		CBLCollection_EnumerateDocuments;
+		CBLDocumentEnumerator_Next;
+		CBLDocumentEnumerator_DocumentID;
+		CBLDocumentEnumerator_RevisionID;
+		CBLDocumentEnumerator_Sequence;
+		CBLDocumentEnumerator_IsDeleted;
+		CBLDocumentEnumerator_Properties;
+		CBLDocumentEnumerator_GetDocument;
+		CBLCollection_GetChangesSince;
+		CBLChangeBatch_Count;
+		CBLChangeBatch_Get;
+		CBLChangeBatch_LastSequence;
 		CBLCollection_AddChangeListener;
 		CBLCollection_AddDocumentChangeListener;
 		CBLCollection_CreateArrayIndex;
@@ -201,20 +235,33 @@ CBL_C {
 		CBLLogSinks_SetFile;
 		CBLLogSinks_File;
 		CBLDatabase_CreateQuery;
+		CBLDatabase_SetQueryCacheCapacity;
+		CBLDatabase_GetQueryCacheStats;
+		CBLDatabase_CreateKeysetQuery;
 		CBLQuery_Parameters;
 		CBLQuery_SetParameters;
 		CBLQuery_Execute;
+		CBLQuery_ExecuteBatch;
+		CBLQuery_ExecuteAsync;
+		CBLQueryTask_Cancel;
+		CBLQuery_SetProfilingEnabled;
 		CBLQuery_Explain;
 		CBLQuery_ColumnCount;
 		CBLQuery_ColumnName;
+		CBLQuery_ColumnIndex;
 		CBLQuery_AddChangeListener;
 		CBLQuery_CopyCurrentResults;
 		CBLResultSet_Next;
+		CBLResultSet_NextBatch;
+		CBLResultSet_WriteJSON;
 		CBLResultSet_ValueAtIndex;
 		CBLResultSet_ValueForKey;
+		CBLResultSet_GetColumnValues;
 		CBLResultSet_ResultArray;
 		CBLResultSet_ResultDict;
 		CBLResultSet_GetQuery;
+		CBLResultSet_ContinuationToken;
+		CBLResultSet_Stats;
 		CBLQueryIndex_Collection;
 		CBLQueryIndex_Name;
 		kCBLAuthDefaultCookieName;
@@ -246,6 +293,7 @@ CBL_C {
 		CBLDatabase_PublicUUID;
 		CBLDocument_CanonicalRevisionID;
 		CBLDocument_GetRevisionHistory;
+		CBLDocument_ReusedBodyCount;
 		CBLError_GetCaptureBacktraces;
 		CBLError_SetCaptureBacktraces;
 		CBLQuery_SetListenerCallbackDelay;
@@ -256,6 +304,7 @@ CBL_C {
 		CBL_DeleteDirectoryRecursive;
 		kCBLDefaultDatabaseFullSync;
 		kCBLDefaultDatabaseMmapDisabled;
+		kCBLDefaultDatabaseSingleThreaded;
 		kCBLDefaultLogFileUsePlaintext;
 		kCBLDefaultLogFileMaxSize;
 		kCBLDefaultLogFileMaxRotateCount;
@@ -20,6 +20,7 @@
 #include "CBLPrivate.h"
 #include "fleece/Fleece.hh"
 #include "fleece/Mutable.hh"
+#include <atomic>
 #include <mutex>
 #include <string>
 #include <thread>
@@ -346,6 +347,69 @@ TEST_CASE_METHOD(DatabaseTest, "TestDBWithFullSync") {
     CBLDatabase_Release(fullSyncDB);
 }
 
+TEST_CASE_METHOD(DatabaseTest, "Single-Threaded Database") {
+    auto config = databaseConfig();
+    CHECK(!config.singleThreaded);
+    
+    auto dbname = "singlethreadeddb"_sl;
+    CBL_DeleteDatabase(dbname, config.directory, nullptr);
+    
+    config.singleThreaded = true;
+    CBLError error {};
+    CBLDatabase* stDB = CBLDatabase_Open(dbname, &config, &error);
+    REQUIRE(stDB);
+    CHECK(CBLDatabase_Config(stDB).singleThreaded);
+    
+    CBLCollection* col = CBLDatabase_DefaultCollection(stDB, &error);
+    REQUIRE(col);
+    
+    int changes = 0;
+    CBLListenerToken* token = CBLCollection_AddChangeListener(col, [](void* context, const CBLCollectionChange*) {
+        ++*(int*)context;
+    }, &changes);
+    
+    CBLDocument* doc = CBLDocument_CreateWithID("doc1"_sl);
+    FLMutableDict_SetString(CBLDocument_MutableProperties(doc), "foo"_sl, "bar"_sl);
+    REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+    CHECK(changes == 1);
+    
+    const CBLDocument* readDoc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    REQUIRE(readDoc);
+    CHECK(Dict(CBLDocument_Properties(readDoc))["foo"].asString() == "bar"_sl);
+    CBLDocument_Release(readDoc);
+    
+    CBLQuery* query = CBLDatabase_CreateQuery(stDB, kCBLN1QLLanguage, "SELECT foo FROM _"_sl, nullptr, &error);
+    REQUIRE(query);
+    CBLResultSet* rs = CBLQuery_Execute(query, &error);
+    REQUIRE(rs);
+    CHECK(CBLResultSet_Next(rs));
+    CHECK(!CBLResultSet_Next(rs));
+    CBLResultSet_Release(rs);
+    
+    {
+        // Features that call into the database from other threads are unsupported:
+        ExpectingExceptions x;
+        CHECK(!CBLCollection_SaveDocumentAsync(col, doc, kCBLConcurrencyControlLastWriteWins,
+                                               nullptr, nullptr, &error));
+        CheckError(error, kCBLErrorUnsupported);
+        CHECK(!CBLQuery_AddChangeListener(query, [](void*, CBLQuery*, CBLListenerToken*) { }, nullptr));
+    }
+    
+    // Deferred durability syncs immediately, since there's no background thread:
+    REQUIRE(CBLDatabase_BeginTransaction(stDB, &error));
+    FLMutableDict_SetString(CBLDocument_MutableProperties(doc), "foo"_sl, "baz"_sl);
+    REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+    REQUIRE(CBLDatabase_EndTransactionWithDurability(stDB, true, kCBLDurabilityDeferred, &error));
+    CHECK(CBLCollection_LastDurableSequence(col) == CBLDocument_Sequence(doc));
+    
+    CBLQuery_Release(query);
+    CBLDocument_Release(doc);
+    CBLListener_Remove(token);
+    CBLCollection_Release(col);
+    CHECK(CBLDatabase_Close(stDB, &error));
+    CBLDatabase_Release(stDB);
+}
+
 #pragma mark - Save Document:
 
 TEST_CASE_METHOD(DatabaseTest, "Save Document into Different DB Instance") {
@@ -600,6 +664,211 @@ TEST_CASE_METHOD(DatabaseTest, "Transaction Abort") {
     CBLDocument_Release(doc2);
 }
 
+
+TEST_CASE_METHOD(DatabaseTest, "Transaction Durability") {
+    CBLError error;
+    CHECK(CBLCollection_LastDurableSequence(defaultCollection) == 0);
+    
+    SECTION("Immediate") {
+        REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+        createDocWithPair(db, "doc1", "foo", "bar1");
+        REQUIRE(CBLDatabase_EndTransactionWithDurability(db, true, kCBLDurabilityImmediate, &error));
+        CHECK(CBLCollection_LastDurableSequence(defaultCollection) == CBLCollection_LastSequence(defaultCollection));
+    }
+    
+    SECTION("Nested") {
+        // The outermost transaction applies the strongest durability of the nested ones:
+        REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+        REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+        createDocWithPair(db, "doc1", "foo", "bar1");
+        REQUIRE(CBLDatabase_EndTransactionWithDurability(db, true, kCBLDurabilityImmediate, &error));
+        CHECK(CBLCollection_LastDurableSequence(defaultCollection) == 0);
+        REQUIRE(CBLDatabase_EndTransactionWithDurability(db, true, kCBLDurabilityNone, &error));
+        CHECK(CBLCollection_LastDurableSequence(defaultCollection) == CBLCollection_LastSequence(defaultCollection));
+    }
+    
+    SECTION("Deferred") {
+        CBLDatabase_SetDeferredDurabilityInterval(db, 10);
+        REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+        createDocWithPair(db, "doc1", "foo", "bar1");
+        REQUIRE(CBLDatabase_EndTransactionWithDurability(db, true, kCBLDurabilityDeferred, &error));
+        REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+        createDocWithPair(db, "doc2", "foo", "bar2");
+        REQUIRE(CBLDatabase_EndTransactionWithDurability(db, true, kCBLDurabilityDeferred, &error));
+        
+        uint64_t lastSequence = CBLCollection_LastSequence(defaultCollection);
+        for (int i = 0; i < 500 && CBLCollection_LastDurableSequence(defaultCollection) < lastSequence; ++i)
+            this_thread::sleep_for(chrono::milliseconds(10));
+        CHECK(CBLCollection_LastDurableSequence(defaultCollection) == lastSequence);
+    }
+    
+    SECTION("None or Aborted") {
+        REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+        createDocWithPair(db, "doc1", "foo", "bar1");
+        REQUIRE(CBLDatabase_EndTransactionWithDurability(db, true, kCBLDurabilityNone, &error));
+        REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+        createDocWithPair(db, "doc2", "foo", "bar2");
+        REQUIRE(CBLDatabase_EndTransactionWithDurability(db, false, kCBLDurabilityImmediate, &error));
+        CHECK(CBLCollection_LastDurableSequence(defaultCollection) == 0);
+    }
+}
+
+#pragma mark - Reader Pool:
+
+
+TEST_CASE_METHOD(DatabaseTest, "Reader Pool") {
+    createDocWithPair(db, "doc1", "foo", "bar1");
+    createDocWithPair(db, "doc2", "foo", "bar2");
+    
+    CBLError error;
+    CHECK(CBLDatabase_ReaderPoolSize(db) == 0);
+    REQUIRE(CBLDatabase_SetReaderPoolSize(db, 4, &error));
+    CHECK(CBLDatabase_ReaderPoolSize(db) == 4);
+    
+    // Read and query concurrently:
+    atomic<int> failures {0};
+    vector<thread> threads;
+    for (int t = 0; t < 6; t++) {
+        threads.emplace_back([&] {
+            CBLError err;
+            CBLQuery* query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
+                                                      "SELECT foo FROM _ ORDER BY foo"_sl,
+                                                      nullptr, &err);
+            if (!query) {
+                ++failures;
+                return;
+            }
+            for (int i = 0; i < 50; i++) {
+                const CBLDocument* doc = CBLCollection_GetDocument(defaultCollection, "doc1"_sl, &err);
+                if (!doc || Dict(CBLDocument_Properties(doc))["foo"].asString() != "bar1"_sl)
+                    ++failures;
+                CBLDocument_Release(doc);
+                
+                CBLResultSet* rs = CBLQuery_Execute(query, &err);
+                int rows = 0;
+                while (rs && CBLResultSet_Next(rs))
+                    ++rows;
+                if (rows != 2)
+                    ++failures;
+                CBLResultSet_Release(rs);
+            }
+            CBLQuery_Release(query);
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    CHECK(failures == 0);
+    
+    // Committed changes are visible to the readers:
+    createDocWithPair(db, "doc3", "foo", "bar3");
+    CHECK(CBLCollection_Count(defaultCollection) == 3);
+    
+    // A document read from a reader can be saved:
+    const CBLDocument* doc1 = CBLCollection_GetDocument(defaultCollection, "doc1"_sl, &error);
+    REQUIRE(doc1);
+    CBLDocument* mdoc1 = CBLDocument_MutableCopy(doc1);
+    FLMutableDict_SetString(CBLDocument_MutableProperties(mdoc1), "foo"_sl, "baz1"_sl);
+    REQUIRE(CBLCollection_SaveDocumentWithConcurrencyControl(defaultCollection, mdoc1,
+                                                             kCBLConcurrencyControlFailOnConflict, &error));
+    CBLDocument_Release(mdoc1);
+    
+    // ... but not if it has been changed since:
+    mdoc1 = CBLDocument_MutableCopy(doc1);
+    CHECK(!CBLCollection_SaveDocumentWithConcurrencyControl(defaultCollection, mdoc1,
+                                                            kCBLConcurrencyControlFailOnConflict, &error));
+    CheckError(error, kCBLErrorConflict);
+    CBLDocument_Release(mdoc1);
+    CBLDocument_Release(doc1);
+    
+    // Uncommitted changes are visible in a transaction:
+    REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+    createDocWithPair(db, "doc4", "foo", "bar4");
+    CHECK(CBLCollection_Count(defaultCollection) == 4);
+    REQUIRE(CBLDatabase_EndTransaction(db, true, &error));
+    
+    // A document outlives the readers:
+    doc1 = CBLCollection_GetDocument(defaultCollection, "doc1"_sl, &error);
+    REQUIRE(doc1);
+    
+    REQUIRE(CBLDatabase_SetReaderPoolSize(db, 0, &error));
+    CHECK(CBLDatabase_ReaderPoolSize(db) == 0);
+    CHECK(CBLCollection_Count(defaultCollection) == 4);
+    
+    CHECK(CBLDocument_RevisionID(doc1));
+    mdoc1 = CBLDocument_MutableCopy(doc1);
+    FLMutableDict_SetString(CBLDocument_MutableProperties(mdoc1), "foo"_sl, "baz2"_sl);
+    CHECK(CBLCollection_SaveDocumentWithConcurrencyControl(defaultCollection, mdoc1,
+                                                           kCBLConcurrencyControlFailOnConflict, &error));
+    CBLDocument_Release(mdoc1);
+    CBLDocument_Release(doc1);
+}
+
+
+#pragma mark - Lock Stats:
+
+
+static uint64_t histogramTotal(const CBLLockCategoryStats &stats) {
+    uint64_t total = 0;
+    for (auto count : stats.holdHistogram)
+        total += count;
+    return total;
+}
+
+
+TEST_CASE_METHOD(DatabaseTest, "Lock Stats") {
+    // Nothing is recorded while disabled:
+    createDocWithPair(db, "doc1", "foo", "bar1");
+    CBLLockStats stats = CBLDatabase_GetLockStats(db);
+    CHECK(stats.documentWrite.acquisitions == 0);
+    CHECK(stats.documentRead.acquisitions == 0);
+    
+    CBLDatabase_SetLockStatsEnabled(db, true);
+    createDocWithPair(db, "doc2", "foo", "bar2");
+    
+    CBLError error;
+    const CBLDocument* doc = CBLCollection_GetDocument(defaultCollection, "doc1"_sl, &error);
+    REQUIRE(doc);
+    CBLDocument_Release(doc);
+    
+    CBLQuery* query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage, "SELECT foo FROM _"_sl,
+                                              nullptr, &error);
+    REQUIRE(query);
+    CBLResultSet* rs = CBLQuery_Execute(query, &error);
+    REQUIRE(rs);
+    int rows = 0;
+    while (CBLResultSet_Next(rs))
+        ++rows;
+    CHECK(rows == 2);
+    CBLResultSet_Release(rs);
+    CBLQuery_Release(query);
+    
+    REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+    REQUIRE(CBLDatabase_EndTransaction(db, true, &error));
+    
+    stats = CBLDatabase_GetLockStats(db);
+    CHECK(stats.transaction.acquisitions == 2);
+    CHECK(stats.documentWrite.acquisitions >= 1);
+    CHECK(stats.documentRead.acquisitions >= 1);
+    CHECK(stats.query.acquisitions >= 2);
+    CHECK(histogramTotal(stats.documentWrite) == stats.documentWrite.acquisitions);
+    CHECK(histogramTotal(stats.query) == stats.query.acquisitions);
+    CHECK(stats.documentWrite.maxHoldNS <= stats.documentWrite.totalHoldNS);
+    CHECK(stats.documentWrite.maxWaitNS <= stats.documentWrite.totalWaitNS);
+    
+    CBLDatabase_ResetLockStats(db);
+    stats = CBLDatabase_GetLockStats(db);
+    CHECK(stats.documentWrite.acquisitions == 0);
+    CHECK(stats.documentRead.acquisitions == 0);
+    CHECK(stats.query.acquisitions == 0);
+    CHECK(stats.query.totalHoldNS == 0);
+    
+    CBLDatabase_SetLockStatsEnabled(db, false);
+    createDocWithPair(db, "doc3", "foo", "bar3");
+    stats = CBLDatabase_GetLockStats(db);
+    CHECK(stats.documentWrite.acquisitions == 0);
+}
+
+
 #pragma mark - BLOBS:
 
 TEST_CASE_METHOD(DatabaseTest, "Save blob read from database", "[Blob]") {
@@ -20,6 +20,9 @@
 #include "CBLPrivate.h"
 #include "fleece/Fleece.hh"
 #include "fleece/Mutable.hh"
+#include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <thread>
 
 using namespace fleece;
@@ -79,6 +82,17 @@ public:
         REQUIRE(saved);
     }
 
+    void updateDocument(CBLCollection* collection, slice docID, slice property, slice value) {
+        CBLError error = {};
+        CBLDocument* doc = CBLCollection_GetMutableDocument(collection, docID, &error);
+        REQUIRE(doc);
+        MutableDict props = CBLDocument_MutableProperties(doc);
+        FLSlot_SetString(FLMutableDict_Set(props, property), value);
+        bool saved = CBLCollection_SaveDocument(collection, doc, &error);
+        CBLDocument_Release(doc);
+        REQUIRE(saved);
+    }
+
     ~DocumentTest() {
         CBLCollection_Release(col);
         CBLCollection_Release(otherCol);
@@ -174,6 +188,126 @@ TEST_CASE_METHOD(DocumentTest, "Mutable Copy Immutable Document", "[Document]")
     CBLDocument_Release(mDoc);
 }
 
+TEST_CASE_METHOD(DocumentTest, "Mutable Copy Is Independent of Original", "[Document]") {
+    CBLDocument* doc = CBLDocument_CreateWithID("foo"_sl);
+    CBLError error;
+    REQUIRE(CBLDocument_SetJSON(doc, "{\"name\":{\"first\":\"Lue\"},\"tags\":[1,2]}"_sl, &error));
+    REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+    CBLDocument_Release(doc);
+    
+    doc = CBLCollection_GetMutableDocument(col, "foo"_sl, &error);
+    REQUIRE(doc);
+    MutableDict props = CBLDocument_MutableProperties(doc);
+    props.getMutableDict("name")["first"] = "Jasper";
+    
+    CBLDocument* mDoc = CBLDocument_MutableCopy(doc);
+    MutableDict copyProps = CBLDocument_MutableProperties(mDoc);
+    // The unmodified immutable array is shared, not copied:
+    CHECK(copyProps["tags"].asArray() == props["tags"].asArray());
+    CHECK(!copyProps["tags"].asArray().asMutable());
+    copyProps.getMutableDict("name")["first"] = "Sue";
+    copyProps.getMutableArray("tags").append(3);
+    
+    CHECK(alloc_slice(CBLDocument_CreateJSON(doc)) == "{\"name\":{\"first\":\"Jasper\"},\"tags\":[1,2]}"_sl);
+    CHECK(alloc_slice(CBLDocument_CreateJSON(mDoc)) == "{\"name\":{\"first\":\"Sue\"},\"tags\":[1,2,3]}"_sl);
+    
+    CBLDocument_Release(doc);
+    CBLDocument_Release(mDoc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Mutable Copy of Document Set from JSON", "[Document]") {
+    createDocument(col, "foo", "greeting", "Howdy!");
+    
+    CBLError error;
+    CBLDocument* doc = CBLCollection_GetMutableDocument(col, "foo"_sl, &error);
+    REQUIRE(doc);
+    REQUIRE(CBLDocument_SetJSON(doc, "{\"greeting\":\"Hi!\"}"_sl, &error));
+    
+    CBLDocument* mDoc = CBLDocument_MutableCopy(doc);
+    CHECK(alloc_slice(CBLDocument_CreateJSON(mDoc)) == "{\"greeting\":\"Hi!\"}"_sl);
+    
+    CBLDocument_Release(doc);
+    CBLDocument_Release(mDoc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Save Unchanged Mutable Document", "[Document]") {
+    createDocument(col, "foo", "greeting", "Howdy!");
+    
+    CBLError error;
+    CBLDocument* doc = CBLCollection_GetMutableDocument(col, "foo"_sl, &error);
+    REQUIRE(doc);
+    
+    SECTION("Properties Not Accessed") { }
+    
+    SECTION("Properties Accessed") {
+        MutableDict props = CBLDocument_MutableProperties(doc);
+        CHECK(props["greeting"].asString() == "Howdy!"_sl);
+    }
+    
+    SECTION("Nested Collection Promoted But Unchanged") {
+        REQUIRE(CBLDocument_SetJSON(doc, "{\"greeting\":\"Howdy!\",\"name\":{\"first\":\"Lue\"}}"_sl, &error));
+        REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+        CBLDocument_Release(doc);
+        doc = CBLCollection_GetMutableDocument(col, "foo"_sl, &error);
+        REQUIRE(doc);
+        MutableDict props = CBLDocument_MutableProperties(doc);
+        CHECK(props.getMutableDict("name")["first"].asString() == "Lue"_sl);
+    }
+    
+    alloc_slice json = CBLDocument_CreateJSON(doc);
+    uint64_t sequence = CBLDocument_Sequence(doc);
+    uint64_t reusedBodies = CBLDocument_ReusedBodyCount();
+    REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+    CHECK(CBLDocument_Sequence(doc) == sequence + 1);
+    CHECK(CBLDocument_ReusedBodyCount() == reusedBodies + 1);   // The body wasn't encoded again
+    CBLDocument_Release(doc);
+    
+    const CBLDocument* rDoc = CBLCollection_GetDocument(col, "foo"_sl, &error);
+    REQUIRE(rDoc);
+    CHECK(alloc_slice(CBLDocument_CreateJSON(rDoc)) == json);
+    CBLDocument_Release(rDoc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Save Mutable Document with Replaced Properties", "[Document]") {
+    createDocument(col, "foo", "greeting", "Howdy!");
+    
+    CBLError error;
+    CBLDocument* doc = CBLCollection_GetMutableDocument(col, "foo"_sl, &error);
+    REQUIRE(doc);
+    
+    uint64_t reusedBodies = CBLDocument_ReusedBodyCount();
+    slice expectedJSON;
+    
+    SECTION("Replaced by Empty Dictionary") {
+        expectedJSON = "{}"_sl;
+        // A new empty dictionary is unchanged, but isn't the revision's body:
+        MutableDict empty = MutableDict::newDict();
+        CBLDocument_SetProperties(doc, empty);
+    }
+    
+    SECTION("Nested Collection Changed") {
+        expectedJSON = "{\"name\":{\"first\":\"Sue\"}}"_sl;
+        // Only the nested collection is changed, so the root is still the unchanged copy:
+        REQUIRE(CBLDocument_SetJSON(doc, "{\"name\":{\"first\":\"Lue\"}}"_sl, &error));
+        REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+        CBLDocument_Release(doc);
+        doc = CBLCollection_GetMutableDocument(col, "foo"_sl, &error);
+        REQUIRE(doc);
+        reusedBodies = CBLDocument_ReusedBodyCount();
+        MutableDict props = CBLDocument_MutableProperties(doc);
+        props.getMutableDict("name")["first"] = "Sue";
+    }
+    
+    REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+    CHECK(CBLDocument_ReusedBodyCount() == reusedBodies);      // The body was encoded
+    CBLDocument_Release(doc);
+    
+    const CBLDocument* rDoc = CBLCollection_GetDocument(col, "foo"_sl, &error);
+    REQUIRE(rDoc);
+    CHECK(alloc_slice(CBLDocument_CreateJSON(rDoc)) == expectedJSON);
+    CBLDocument_Release(rDoc);
+}
+
 TEST_CASE_METHOD(DocumentTest, "Access nested collections from mutable props", "[Document]") {
     CBLError error;
     CBLDocument* doc = CBLDocument_CreateWithID("foo"_sl);
@@ -334,6 +468,277 @@ TEST_CASE_METHOD(DocumentTest, "Get Document with Empty ID", "[Document]") {
     CHECK(error.code == 0);
 }
 
+TEST_CASE_METHOD(DocumentTest, "Get Multiple Documents", "[Document]") {
+    createDocument(col, "doc1", "foo", "bar1");
+    createDocument(col, "doc3", "foo", "bar3");
+    
+    Doc docIDs = Doc::fromJSON("[\"doc1\", \"doc2\", \"doc3\", \"\"]"_sl);
+    const CBLDocument* docs[4] = {};
+    CBLError error {};
+    ExpectingExceptions x; // Empty docID
+    REQUIRE(CBLCollection_GetDocuments(col, docIDs.root().asArray(), docs, &error));
+    
+    REQUIRE(docs[0]);
+    CHECK(CBLDocument_ID(docs[0]) == "doc1"_sl);
+    CHECK(Dict(CBLDocument_Properties(docs[0]))["foo"].asString() == "bar1"_sl);
+    CHECK(docs[1] == nullptr);
+    REQUIRE(docs[2]);
+    CHECK(CBLDocument_ID(docs[2]) == "doc3"_sl);
+    CHECK(Dict(CBLDocument_Properties(docs[2]))["foo"].asString() == "bar3"_sl);
+    CHECK(docs[3] == nullptr);
+    
+    for (auto doc : docs)
+        CBLDocument_Release(doc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Get Multiple Documents with Invalid IDs", "[Document]") {
+    Doc docIDs = Doc::fromJSON("[\"doc1\", 2]"_sl);
+    const CBLDocument* docs[2] = {};
+    CBLError error {};
+    ExpectingExceptions x;
+    CHECK(!CBLCollection_GetDocuments(col, docIDs.root().asArray(), docs, &error));
+    CheckError(error, kCBLErrorInvalidParameter);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Read Document", "[Document]") {
+    createDocument(col, "doc1", "foo", "bar");
+    
+    const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, nullptr);
+    REQUIRE(doc);
+    
+    struct ReadResult {
+        alloc_slice docID, revID, json;
+        uint64_t sequence = 0, timestamp = 0;
+        int calls = 0;
+    } result;
+    
+    auto callback = [](void* context, const CBLDocumentRevisionInfo* revision) {
+        auto result = (ReadResult*)context;
+        result->calls++;
+        result->docID = revision->docID;
+        result->revID = revision->revisionID;
+        result->sequence = revision->sequence;
+        result->timestamp = revision->timestamp;
+        result->json = Dict(revision->properties).toJSON();
+    };
+    
+    CBLError error {};
+    REQUIRE(CBLCollection_ReadDocument(col, "doc1"_sl, callback, &result, &error));
+    CHECK(result.calls == 1);
+    CHECK(result.docID == "doc1"_sl);
+    CHECK(result.revID == slice(CBLDocument_RevisionID(doc)));
+    CHECK(result.sequence == CBLDocument_Sequence(doc));
+    CHECK(result.timestamp == CBLDocument_Timestamp(doc));
+    CHECK(result.json == "{\"foo\":\"bar\"}"_sl);
+    CBLDocument_Release(doc);
+    
+    // Non-existing document:
+    result = {};
+    error.code = 1;
+    CHECK(!CBLCollection_ReadDocument(col, "doc2"_sl, callback, &result, &error));
+    CHECK(error.code == 0);
+    CHECK(result.calls == 0);
+    
+    // Deleted document:
+    doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    REQUIRE(doc);
+    REQUIRE(CBLCollection_DeleteDocument(col, doc, &error));
+    CBLDocument_Release(doc);
+    CHECK(!CBLCollection_ReadDocument(col, "doc1"_sl, callback, &result, &error));
+    CHECK(error.code == 0);
+    CHECK(result.calls == 0);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Read Document with Blob", "[Document][Blob]") {
+    CBLError error {};
+    CBLBlob* blob = CBLBlob_CreateWithData("text/plain"_sl, "blob content"_sl);
+    CBLDocument* doc = CBLDocument_CreateWithID("doc1"_sl);
+    FLMutableDict_SetBlob(CBLDocument_MutableProperties(doc), "blob"_sl, blob);
+    REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+    CBLDocument_Release(doc);
+    CBLBlob_Release(blob);
+    
+    alloc_slice content;
+    auto callback = [](void* context, const CBLDocumentRevisionInfo* revision) {
+        FLDict blobDict = FLValue_AsDict(FLDict_Get(revision->properties, "blob"_sl));
+        const CBLBlob* blob = FLDict_GetBlob(blobDict);
+        REQUIRE(blob);
+        CBLError error {};
+        *(alloc_slice*)context = alloc_slice(CBLBlob_Content(blob, &error));
+    };
+    REQUIRE(CBLCollection_ReadDocument(col, "doc1"_sl, callback, &content, &error));
+    CHECK(content == "blob content"_sl);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Read Immutable Document Concurrently", "[Document]") {
+    createDocument(col, "doc1", "foo", "bar");
+    
+    CBLError error;
+    const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    REQUIRE(doc);
+    
+    // Immutable documents' accessors don't lock, and may be called from any number of threads:
+    std::atomic<int> mismatches {0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 1000; ++i) {
+                Dict props = CBLDocument_Properties(doc);
+                alloc_slice json(CBLDocument_CreateJSON(doc));
+                if (CBLDocument_Sequence(doc) != 1 || props["foo"].asString() != "bar"_sl
+                        || json != "{\"foo\":\"bar\"}"_sl)
+                    ++mismatches;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    CHECK(mismatches == 0);
+    CHECK(CBLDocument_Properties(doc) == CBLDocument_Properties(doc));
+    
+    // Deleting the document updates its revision info, but not the properties it was loaded with:
+    REQUIRE(CBLCollection_DeleteDocument(col, doc, &error));
+    CHECK(CBLDocument_Sequence(doc) == 2);
+    CHECK(Dict(CBLDocument_Properties(doc))["foo"].asString() == "bar"_sl);
+    CBLDocument_Release(doc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Document Cache", "[Document][Cache]") {
+    createDocument(col, "doc1", "foo", "bar");
+    createDocument(col, "doc2", "foo", "bar");
+    createDocument(col, "doc3", "foo", "bar");
+    
+    CBLError error {};
+    
+    // Disabled by default:
+    const CBLDocument* doc1 = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    const CBLDocument* doc1Again = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    CHECK(doc1 != doc1Again);
+    CBLDocument_Release(doc1);
+    CBLDocument_Release(doc1Again);
+    CHECK(CBLCollection_GetDocumentCacheStats(col).capacity == 0);
+    
+    REQUIRE(CBLCollection_SetDocumentCacheCapacity(col, 2, &error));
+    
+    doc1 = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    REQUIRE(doc1);
+    doc1Again = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    CHECK(doc1 == doc1Again);
+    CHECK(CBLDocument_Collection(doc1) == col);
+    CBLDocument_Release(doc1Again);
+    
+    CBLDocumentCacheStats stats = CBLCollection_GetDocumentCacheStats(col);
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.count == 1);
+    CHECK(stats.capacity == 2);
+    
+    // Missing documents aren't cached:
+    CHECK(!CBLCollection_GetDocument(col, "nope"_sl, &error));
+    CHECK(error.code == 0);
+    CHECK(CBLCollection_GetDocumentCacheStats(col).count == 1);
+    
+    SECTION("Eviction") {
+        const CBLDocument* doc2 = CBLCollection_GetDocument(col, "doc2"_sl, &error);
+        const CBLDocument* doc3 = CBLCollection_GetDocument(col, "doc3"_sl, &error);
+        stats = CBLCollection_GetDocumentCacheStats(col);
+        CHECK(stats.count == 2);
+        CHECK(stats.evictions == 1);
+        
+        // doc1 was the least recently used:
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        CHECK(doc != doc1);
+        CBLDocument_Release(doc);
+        doc = CBLCollection_GetDocument(col, "doc3"_sl, &error);
+        CHECK(doc == doc3);
+        CBLDocument_Release(doc);
+        
+        CBLDocument_Release(doc2);
+        CBLDocument_Release(doc3);
+    }
+    
+    SECTION("Invalidation on Save") {
+        updateDocument(col, "doc1", "foo", "baz");
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        REQUIRE(doc);
+        CHECK(doc != doc1);
+        CHECK(Dict(CBLDocument_Properties(doc))["foo"].asString() == "baz"_sl);
+        CBLDocument_Release(doc);
+        CHECK(CBLCollection_GetDocumentCacheStats(col).invalidations == 1);
+    }
+    
+    SECTION("Invalidation with Buffered Notifications") {
+        CBLDatabase_BufferNotifications(db, [](void*, CBLDatabase*) { }, nullptr);
+        updateDocument(col, "doc1", "foo", "baz");
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        REQUIRE(doc);
+        CHECK(doc != doc1);
+        CHECK(Dict(CBLDocument_Properties(doc))["foo"].asString() == "baz"_sl);
+        CBLDocument_Release(doc);
+        CBLDatabase_SendNotifications(db);
+        CHECK(CBLCollection_GetDocumentCacheStats(col).count == 1);
+    }
+    
+    SECTION("Invalidation on Purge") {
+        REQUIRE(CBLCollection_PurgeDocumentByID(col, "doc1"_sl, &error));
+        CHECK(!CBLCollection_GetDocument(col, "doc1"_sl, &error));
+        CHECK(error.code == 0);
+    }
+    
+    SECTION("Deleting a Cached Document") {
+        alloc_slice revID(CBLDocument_RevisionID(doc1));
+        REQUIRE(CBLCollection_DeleteDocument(col, doc1, &error));
+        // Other readers of the cached instance don't see it change:
+        CHECK(CBLDocument_RevisionID(doc1) == revID);
+        CHECK(Dict(CBLDocument_Properties(doc1))["foo"].asString() == "bar"_sl);
+        CHECK(!CBLCollection_GetDocument(col, "doc1"_sl, &error));
+        CHECK(error.code == 0);
+    }
+    
+    SECTION("In a Transaction") {
+        REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+        updateDocument(col, "doc1", "foo", "baz");
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        REQUIRE(doc);
+        CHECK(Dict(CBLDocument_Properties(doc))["foo"].asString() == "baz"_sl);
+        CBLDocument_Release(doc);
+        REQUIRE(CBLDatabase_EndTransaction(db, false, &error));
+        
+        doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        CHECK(doc == doc1);
+        CBLDocument_Release(doc);
+    }
+    
+    SECTION("Invalidation from Another Connection") {
+        auto config = databaseConfig();
+        CBLDatabase* otherDB = CBLDatabase_Open(kDatabaseName, &config, &error);
+        REQUIRE(otherDB);
+        CBLScope* scope = CBLCollection_Scope(col);
+        CBLCollection* otherDBCol = CBLDatabase_Collection(otherDB, CBLCollection_Name(col), CBLScope_Name(scope), &error);
+        CBLScope_Release(scope);
+        REQUIRE(otherDBCol);
+        updateDocument(otherDBCol, "doc1", "foo", "baz");
+        CBLCollection_Release(otherDBCol);
+        CHECK(CBLDatabase_Close(otherDB, &error));
+        CBLDatabase_Release(otherDB);
+        
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        REQUIRE(doc);
+        CHECK(Dict(CBLDocument_Properties(doc))["foo"].asString() == "baz"_sl);
+        CBLDocument_Release(doc);
+    }
+    
+    SECTION("Disable") {
+        REQUIRE(CBLCollection_SetDocumentCacheCapacity(col, 0, &error));
+        CHECK(CBLCollection_GetDocumentCacheStats(col).count == 0);
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        CHECK(doc != doc1);
+        CBLDocument_Release(doc);
+    }
+    
+    CBLDocument_Release(doc1);
+}
+
 #pragma mark - Save Document:
 
 TEST_CASE_METHOD(DocumentTest, "Save Empty Document", "[Document]") {
@@ -504,6 +909,313 @@ TEST_CASE_METHOD(DocumentTest, "Save Document with FailOnConflict", "[Document]"
     CBLDocument_Release(doc);
 }
 
+TEST_CASE_METHOD(DocumentTest, "Save Multiple Documents", "[Document]") {
+    createDocument(col, "doc2", "greeting", "Hi!");
+    
+    CBLError error {};
+    CBLDocument* docs[3];
+    docs[0] = CBLDocument_CreateWithID("doc1"_sl);
+    docs[1] = CBLCollection_GetMutableDocument(col, "doc2"_sl, &error);
+    REQUIRE(docs[1]);
+    docs[2] = CBLDocument_CreateWithID("doc3"_sl);
+    for (auto doc : docs)
+        FLMutableDict_SetString(CBLDocument_MutableProperties(doc), "greeting"_sl, "Howdy!"_sl);
+    
+    bool results[3] = {};
+    REQUIRE(CBLCollection_SaveDocuments(col, docs, 3, kCBLConcurrencyControlFailOnConflict, results, &error));
+    CHECK(results[0]);
+    CHECK(results[1]);
+    CHECK(results[2]);
+    CHECK(CBLCollection_Count(col) == 3);
+    
+    for (auto doc : docs) {
+        CHECK(CBLDocument_Collection(doc) == col);
+        CHECK(CBLDocument_Sequence(doc) > 0);
+        const CBLDocument* saved = CBLCollection_GetDocument(col, CBLDocument_ID(doc), &error);
+        REQUIRE(saved);
+        CHECK(CBLDocument_RevisionID(saved) == CBLDocument_RevisionID(doc));
+        CHECK(Dict(CBLDocument_Properties(saved)).toJSONString() == "{\"greeting\":\"Howdy!\"}");
+        CBLDocument_Release(saved);
+        CBLDocument_Release(doc);
+    }
+}
+
+TEST_CASE_METHOD(DocumentTest, "Save Multiple Documents with Conflict", "[Document]") {
+    createDocument(col, "doc1", "greeting", "Hi!");
+    
+    CBLError error {};
+    CBLDocument* docs[2];
+    docs[0] = CBLCollection_GetMutableDocument(col, "doc1"_sl, &error);
+    REQUIRE(docs[0]);
+    docs[1] = CBLDocument_CreateWithID("doc2"_sl);
+    
+    // Update doc1 after it was loaded to create a conflict:
+    CBLDocument* other = CBLCollection_GetMutableDocument(col, "doc1"_sl, &error);
+    FLMutableDict_SetString(CBLDocument_MutableProperties(other), "greeting"_sl, "Hey!"_sl);
+    REQUIRE(CBLCollection_SaveDocument(col, other, &error));
+    CBLDocument_Release(other);
+    
+    for (auto doc : docs)
+        FLMutableDict_SetString(CBLDocument_MutableProperties(doc), "greeting"_sl, "Howdy!"_sl);
+    
+    bool results[2] = {};
+    SECTION("FailOnConflict") {
+        REQUIRE(CBLCollection_SaveDocuments(col, docs, 2, kCBLConcurrencyControlFailOnConflict, results, &error));
+        CHECK(!results[0]);
+        CHECK(results[1]);
+        
+        const CBLDocument* doc1 = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        CHECK(Dict(CBLDocument_Properties(doc1)).toJSONString() == "{\"greeting\":\"Hey!\"}");
+        CBLDocument_Release(doc1);
+    }
+    
+    SECTION("LastWriteWins") {
+        REQUIRE(CBLCollection_SaveDocuments(col, docs, 2, kCBLConcurrencyControlLastWriteWins, results, &error));
+        CHECK(results[0]);
+        CHECK(results[1]);
+        
+        const CBLDocument* doc1 = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+        CHECK(Dict(CBLDocument_Properties(doc1)).toJSONString() == "{\"greeting\":\"Howdy!\"}");
+        CBLDocument_Release(doc1);
+    }
+    
+    CHECK(CBLCollection_Count(col) == 2);
+    for (auto doc : docs)
+        CBLDocument_Release(doc);
+}
+
+namespace {
+    struct AsyncSaveResults {
+        std::mutex mutex;
+        vector<string> savedIDs;
+        vector<CBLError> errors;
+    };
+
+    void asyncSaveCompletion(void* context, CBLDocument* doc, bool saved, CBLError error) {
+        auto results = (AsyncSaveResults*)context;
+        lock_guard<std::mutex> lock(results->mutex);
+        if (saved)
+            results->savedIDs.push_back(string(slice(CBLDocument_ID(doc))));
+        else
+            results->errors.push_back(error);
+    }
+}
+
+TEST_CASE_METHOD(DocumentTest, "Save Documents Async", "[Document][Async]") {
+    CBLError error {};
+    CBLWriteQueueOptions options = {};
+    options.maxBatchSize = 16;
+    options.maxLatencyMS = 5;
+    REQUIRE(CBLDatabase_SetWriteQueueOptions(db, &options, &error));
+    
+    AsyncSaveResults results;
+    vector<thread> threads;
+    for (int t = 0; t < 4; t++) {
+        threads.emplace_back([&, t] {
+            for (int i = 0; i < 25; i++) {
+                string docID = "doc-" + to_string(t) + "-" + to_string(i);
+                CBLDocument* doc = CBLDocument_CreateWithID(slice(docID));
+                FLMutableDict_SetInt(CBLDocument_MutableProperties(doc), "n"_sl, i);
+                CBLError err {};
+                CHECK(CBLCollection_SaveDocumentAsync(col, doc, kCBLConcurrencyControlFailOnConflict,
+                                                      asyncSaveCompletion, &results, &err));
+                CBLDocument_Release(doc);
+            }
+        });
+    }
+    for (auto &t : threads)
+        t.join();
+    
+    REQUIRE(CBLDatabase_FlushWriteQueue(db, &error));
+    CHECK(CBLCollection_Count(col) == 100);
+    CHECK(results.savedIDs.size() == 100);
+    CHECK(results.errors.empty());
+    
+    const CBLDocument* doc = CBLCollection_GetDocument(col, "doc-3-24"_sl, &error);
+    REQUIRE(doc);
+    CHECK(Dict(CBLDocument_Properties(doc))["n"].asInt() == 24);
+    CBLDocument_Release(doc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Save Document Async with Conflict", "[Document][Async]") {
+    createDocument(col, "doc1", "greeting", "Hi!");
+    
+    CBLError error {};
+    CBLDocument* doc = CBLCollection_GetMutableDocument(col, "doc1"_sl, &error);
+    REQUIRE(doc);
+    
+    // Update doc1 after it was loaded to create a conflict:
+    CBLDocument* other = CBLCollection_GetMutableDocument(col, "doc1"_sl, &error);
+    FLMutableDict_SetString(CBLDocument_MutableProperties(other), "greeting"_sl, "Hey!"_sl);
+    REQUIRE(CBLCollection_SaveDocument(col, other, &error));
+    CBLDocument_Release(other);
+    FLMutableDict_SetString(CBLDocument_MutableProperties(doc), "greeting"_sl, "Howdy!"_sl);
+    
+    AsyncSaveResults results;
+    REQUIRE(CBLCollection_SaveDocumentAsync(col, doc, kCBLConcurrencyControlFailOnConflict,
+                                            asyncSaveCompletion, &results, &error));
+    REQUIRE(CBLDatabase_FlushWriteQueue(db, &error));
+    CHECK(results.savedIDs.empty());
+    REQUIRE(results.errors.size() == 1);
+    CheckError(results.errors[0], kCBLErrorConflict);
+    
+    REQUIRE(CBLCollection_SaveDocumentAsync(col, doc, kCBLConcurrencyControlLastWriteWins,
+                                            asyncSaveCompletion, &results, &error));
+    REQUIRE(CBLDatabase_FlushWriteQueue(db, &error));
+    CHECK(results.savedIDs == vector<string>{"doc1"});
+    CHECK(CBLDocument_Sequence(doc) == 3);
+    CBLDocument_Release(doc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Save Documents Async with Partial Failure", "[Document][Async]") {
+    createDocument(col, "doc2", "greeting", "Hi!");
+    
+    CBLError error {};
+    CBLDocument* conflicting = CBLCollection_GetMutableDocument(col, "doc2"_sl, &error);
+    REQUIRE(conflicting);
+    updateDocument(col, "doc2", "greeting", "Hey!");
+    
+    // Queue the three saves before flushing, so they're committed in the same batch:
+    CBLWriteQueueOptions options = {};
+    options.maxBatchSize = 16;
+    options.maxLatencyMS = 10000;
+    REQUIRE(CBLDatabase_SetWriteQueueOptions(db, &options, &error));
+    
+    AsyncSaveResults results;
+    CBLDocument* doc1 = CBLDocument_CreateWithID("doc1"_sl);
+    CBLDocument* doc3 = CBLDocument_CreateWithID("doc3"_sl);
+    for (CBLDocument* doc : {doc1, conflicting, doc3}) {
+        REQUIRE(CBLCollection_SaveDocumentAsync(col, doc, kCBLConcurrencyControlFailOnConflict,
+                                                asyncSaveCompletion, &results, &error));
+    }
+    REQUIRE(CBLDatabase_FlushWriteQueue(db, &error));
+    
+    // The conflict doesn't keep the other saves from being committed:
+    CHECK(results.savedIDs == vector<string>{"doc1", "doc3"});
+    REQUIRE(results.errors.size() == 1);
+    CheckError(results.errors[0], kCBLErrorConflict);
+    CHECK(CBLCollection_Count(col) == 3);
+    CBLDocument_Release(doc1);
+    CBLDocument_Release(conflicting);
+    CBLDocument_Release(doc3);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Save Document Async in Transaction", "[Document][Async]") {
+    CBLError error {};
+    REQUIRE(CBLDatabase_BeginTransaction(db, &error));
+    
+    AsyncSaveResults results;
+    CBLDocument* doc = CBLDocument_CreateWithID("doc1"_sl);
+    REQUIRE(CBLCollection_SaveDocumentAsync(col, doc, kCBLConcurrencyControlFailOnConflict,
+                                            asyncSaveCompletion, &results, &error));
+    
+    {
+        ExpectingExceptions x;
+        CHECK(!CBLDatabase_FlushWriteQueue(db, &error));
+        CheckError(error, kCBLErrorTransactionNotClosed);
+    }
+    
+    // The save waits for the transaction, so aborting it doesn't roll the save back:
+    this_thread::sleep_for(50ms);
+    {
+        lock_guard<std::mutex> lock(results.mutex);
+        CHECK(results.savedIDs.empty());
+    }
+    REQUIRE(CBLDatabase_EndTransaction(db, false, &error));
+    
+    REQUIRE(CBLDatabase_FlushWriteQueue(db, &error));
+    CHECK(results.savedIDs == vector<string>{"doc1"});
+    CHECK(CBLCollection_Count(col) == 1);
+    CHECK(CBLDocument_Sequence(doc) == 1);
+    CBLDocument_Release(doc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Save Document Async Errors", "[Document][Async]") {
+    createDocument(col, "doc1", "greeting", "Hi!");
+    
+    CBLError error {};
+    const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    REQUIRE(doc);
+    
+    ExpectingExceptions x;
+    CHECK(!CBLCollection_SaveDocumentAsync(col, const_cast<CBLDocument*>(doc),
+                                           kCBLConcurrencyControlFailOnConflict,
+                                           nullptr, nullptr, &error));
+    CheckError(error, kCBLErrorNotWriteable);
+    CBLDocument_Release(doc);
+    
+    CBLDocument* newDoc = CBLDocument_CreateWithID("doc2"_sl);
+    REQUIRE(CBLCollection_SaveDocumentAsync(col, newDoc, kCBLConcurrencyControlFailOnConflict,
+                                            nullptr, nullptr, &error));
+    
+    // Closing the database commits the pending save:
+    REQUIRE(CBLDatabase_Close(db, &error));
+    CHECK(CBLDocument_Sequence(newDoc) == 2);
+    
+    error = {};
+    CHECK(!CBLCollection_SaveDocumentAsync(col, newDoc, kCBLConcurrencyControlFailOnConflict,
+                                           nullptr, nullptr, &error));
+    CheckError(error, kCBLErrorNotOpen);
+    CBLDocument_Release(newDoc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Patch Document", "[Document]") {
+    CBLError error {};
+    CBLDocument* doc = CBLDocument_CreateWithID("foo"_sl);
+    REQUIRE(CBLDocument_SetJSON(doc, "{\"name\":{\"first\":\"Lue\",\"last\":\"Laserna\"},\"count\":1,\"tags\":[1]}"_sl, &error));
+    REQUIRE(CBLCollection_SaveDocument(col, doc, &error));
+    
+    SECTION("FLDict Patch") {
+        Doc patch = Doc::fromJSON("{\"name\":{\"last\":null,\"middle\":\"M\"},\"count\":2,\"tags\":[2],\"new\":true}"_sl);
+        REQUIRE(CBLCollection_PatchDocument(col, "foo"_sl, patch.root().asDict(), &error));
+    }
+    
+    SECTION("JSON Patch") {
+        REQUIRE(CBLCollection_PatchDocumentWithJSON(col, "foo"_sl, "{\"name\":{\"last\":null,\"middle\":\"M\"},\"count\":2,\"tags\":[2],\"new\":true}"_sl, &error));
+    }
+    
+    const CBLDocument* rDoc = CBLCollection_GetDocument(col, "foo"_sl, &error);
+    REQUIRE(rDoc);
+    CHECK(alloc_slice(CBLDocument_CreateJSON(rDoc)) == "{\"count\":2,\"name\":{\"first\":\"Lue\",\"middle\":\"M\"},\"new\":true,\"tags\":[2]}"_sl);
+    CHECK(CBLDocument_Sequence(rDoc) == 2);
+    CBLDocument_Release(rDoc);
+    
+    // The original document is now out of date:
+    CHECK(!CBLCollection_SaveDocumentWithConcurrencyControl(col, doc, kCBLConcurrencyControlFailOnConflict, &error));
+    CheckError(error, kCBLErrorConflict);
+    CBLDocument_Release(doc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Patch Non-Existing or Deleted Document", "[Document]") {
+    CBLError error {};
+    
+    SECTION("Non-Existing") { }
+    
+    SECTION("Deleted") {
+        createDocument(col, "foo", "greeting", "Howdy!");
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "foo"_sl, &error);
+        REQUIRE(doc);
+        REQUIRE(CBLCollection_DeleteDocument(col, doc, &error));
+        CBLDocument_Release(doc);
+    }
+    
+    REQUIRE(CBLCollection_PatchDocumentWithJSON(col, "foo"_sl, "{\"a\":{\"b\":1},\"c\":null}"_sl, &error));
+    const CBLDocument* doc = CBLCollection_GetDocument(col, "foo"_sl, &error);
+    REQUIRE(doc);
+    CHECK(alloc_slice(CBLDocument_CreateJSON(doc)) == "{\"a\":{\"b\":1}}"_sl);
+    CBLDocument_Release(doc);
+}
+
+TEST_CASE_METHOD(DocumentTest, "Patch Document with Invalid Patch", "[Document]") {
+    ExpectingExceptions x;
+    CBLError error {};
+    CHECK(!CBLCollection_PatchDocumentWithJSON(col, "foo"_sl, "[1, 2]"_sl, &error));
+    CHECK(error.domain == kCBLFleeceDomain);
+    CHECK(!CBLCollection_PatchDocumentWithJSON(col, "foo"_sl, "{\"a\":"_sl, &error));
+    CHECK(error.domain == kCBLFleeceDomain);
+    CHECK(CBLCollection_Count(col) == 0);
+}
+
 TEST_CASE_METHOD(DocumentTest, "Save Document with Conflict Handler", "[Document]") {
     CBLDocument* doc = CBLDocument_CreateWithID("foo"_sl);
     FLMutableDict props = CBLDocument_MutableProperties(doc);
@@ -1110,6 +1822,59 @@ TEST_CASE_METHOD(DocumentTest, "Purge Document from Different Collection", "[Doc
     CBLDocument_Release(doc);
 }
 
+TEST_CASE_METHOD(DocumentTest, "Delete and Purge Multiple Documents", "[Document]") {
+    createDocument(col, "doc1", "foo", "bar1");
+    createDocument(col, "doc2", "foo", "bar2");
+    createDocument(col, "doc3", "foo", "bar3");
+    
+    CBLError error {};
+    Doc deleteIDs = Doc::fromJSON("[\"doc1\", \"nope\", \"doc2\"]"_sl);
+    bool deleted[3] = {};
+    REQUIRE(CBLCollection_DeleteDocuments(col, deleteIDs.root().asArray(), deleted, &error));
+    CHECK(deleted[0]);
+    CHECK(!deleted[1]);
+    CHECK(deleted[2]);
+    CHECK(!CBLCollection_GetDocument(col, "doc1"_sl, &error));
+    CHECK(!CBLCollection_GetDocument(col, "doc2"_sl, &error));
+    CHECK(CBLCollection_Count(col) == 1);
+    
+    // Already deleted:
+    REQUIRE(CBLCollection_DeleteDocuments(col, deleteIDs.root().asArray(), deleted, &error));
+    CHECK(!deleted[0]);
+    CHECK(!deleted[2]);
+    
+    // Purge works on tombstones too:
+    Doc purgeIDs = Doc::fromJSON("[\"doc1\", \"doc3\", \"nope\"]"_sl);
+    bool purged[3] = {};
+    REQUIRE(CBLCollection_PurgeDocuments(col, purgeIDs.root().asArray(), purged, &error));
+    CHECK(purged[0]);
+    CHECK(purged[1]);
+    CHECK(!purged[2]);
+    CHECK(CBLCollection_Count(col) == 0);
+    
+    // Results are optional:
+    REQUIRE(CBLCollection_PurgeDocuments(col, purgeIDs.root().asArray(), nullptr, &error));
+}
+
+TEST_CASE_METHOD(DocumentTest, "Delete and Purge Multiple Documents with Invalid IDs", "[Document]") {
+    createDocument(col, "doc1", "foo", "bar1");
+    
+    Doc docIDs = Doc::fromJSON("[\"doc1\", 2]"_sl);
+    CBLError error {};
+    ExpectingExceptions x;
+    CHECK(!CBLCollection_DeleteDocuments(col, docIDs.root().asArray(), nullptr, &error));
+    CheckError(error, kCBLErrorInvalidParameter);
+    
+    error = {};
+    CHECK(!CBLCollection_PurgeDocuments(col, docIDs.root().asArray(), nullptr, &error));
+    CheckError(error, kCBLErrorInvalidParameter);
+    
+    // Nothing was changed:
+    const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    CHECK(doc);
+    CBLDocument_Release(doc);
+}
+
 #pragma mark - Document Expiry:
 
 TEST_CASE_METHOD(DocumentTest, "Document Expiration", "[Document][Expiry]") {
@@ -1168,6 +1933,316 @@ TEST_CASE_METHOD(DocumentTest, "Get and Set Expiration on Non Existing Doc", "[D
     CheckError(error, kCBLErrorNotFound);
 }
 
+#pragma mark - Import:
+
+namespace {
+    struct ImportReaderContext {
+        slice data;
+        size_t chunkSize;
+    };
+
+    int64_t importReader(void* context, void* buffer, size_t bufferSize) {
+        auto ctx = (ImportReaderContext*)context;
+        size_t n = std::min({ctx->data.size, ctx->chunkSize, bufferSize});
+        memcpy(buffer, ctx->data.buf, n);
+        ctx->data.moveStart(n);
+        return int64_t(n);
+    }
+}
+
+TEST_CASE_METHOD(DocumentTest, "Import JSON Lines File", "[Document][Import]") {
+    CBLError error {};
+    uint64_t count = 0;
+    string path = GetAssetFilePath("names_100.json");
+    
+    SECTION("Generated Document IDs") {
+        REQUIRE(CBLCollection_ImportJSONLinesFile(col, slice(path), nullptr, &count, &error));
+        CHECK(count == 100);
+        CHECK(CBLCollection_Count(col) == 100);
+    }
+    
+    SECTION("Document IDs from Key Path") {
+        CBLImportJSONLinesOptions options {};
+        options.docIDKeyPath = "contact.email[0]"_sl;
+        REQUIRE(CBLCollection_ImportJSONLinesFile(col, slice(path), &options, &count, &error));
+        CHECK(count == 100);
+        CHECK(CBLCollection_Count(col) == 100);
+        
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "lue.laserna@nosql-matters.org"_sl, &error);
+        REQUIRE(doc);
+        Dict name = Dict(CBLDocument_Properties(doc))["name"].asDict();
+        CHECK(name["first"].asString() == "Lue"_sl);
+        CHECK(name["last"].asString() == "Laserna"_sl);
+        CBLDocument_Release(doc);
+        
+        // Importing again overwrites the existing documents:
+        REQUIRE(CBLCollection_ImportJSONLinesFile(col, slice(path), &options, &count, &error));
+        CHECK(count == 100);
+        CHECK(CBLCollection_Count(col) == 100);
+    }
+}
+
+TEST_CASE_METHOD(DocumentTest, "Import JSON Lines with Reader", "[Document][Import]") {
+    slice json = "{\"id\":\"doc1\",\"n\":1}\n"
+                 "\r\n"
+                 "{\"id\":\"doc2\",\"n\":2}\r\n"
+                 "{\"id\":\"doc3\",\"n\":3}\n"
+                 "{\"id\":\"doc4\",\"n\":4}\n"
+                 "{\"id\":\"doc5\",\"n\":5}"_sl;
+    ImportReaderContext readerContext {json, 7};
+    
+    vector<uint64_t> progress;
+    bool stop = false;
+    CBLImportJSONLinesOptions options {};
+    options.docIDKeyPath = "id"_sl;
+    options.commitEvery = 2;
+    options.progress = [](void* context, uint64_t docCount) -> bool {
+        auto test = (pair<vector<uint64_t>*, bool*>*)context;
+        test->first->push_back(docCount);
+        return !*test->second;
+    };
+    pair<vector<uint64_t>*, bool*> progressContext {&progress, &stop};
+    options.progressContext = &progressContext;
+    
+    CBLError error {};
+    uint64_t count = 0;
+    
+    SECTION("Complete") {
+        REQUIRE(CBLCollection_ImportJSONLines(col, importReader, &readerContext, &options, &count, &error));
+        CHECK(count == 5);
+        CHECK(progress == vector<uint64_t>{2, 4, 5});
+        CHECK(CBLCollection_Count(col) == 5);
+        
+        for (int i = 1; i <= 5; i++) {
+            string docID = "doc" + to_string(i);
+            const CBLDocument* doc = CBLCollection_GetDocument(col, slice(docID), &error);
+            REQUIRE(doc);
+            CHECK(Dict(CBLDocument_Properties(doc))["n"].asInt() == i);
+            CBLDocument_Release(doc);
+        }
+    }
+    
+    SECTION("Stopped by Progress Callback") {
+        stop = true;
+        REQUIRE(CBLCollection_ImportJSONLines(col, importReader, &readerContext, &options, &count, &error));
+        CHECK(count == 2);
+        CHECK(progress == vector<uint64_t>{2});
+        CHECK(CBLCollection_Count(col) == 2);
+    }
+}
+
+TEST_CASE_METHOD(DocumentTest, "Import JSON Lines with Errors", "[Document][Import]") {
+    ExpectingExceptions x;
+    
+    CBLError error {};
+    uint64_t count = 0;
+    CBLImportJSONLinesOptions options {};
+    options.docIDKeyPath = "id"_sl;
+    options.commitEvery = 2;
+    
+    SECTION("Invalid JSON") {
+        ImportReaderContext readerContext {"{\"id\":\"doc1\"}\n{\"id\":\"doc2\"}\n{\"id\":}\n"_sl, 1024};
+        CHECK(!CBLCollection_ImportJSONLines(col, importReader, &readerContext, &options, &count, &error));
+        CHECK(error.domain == kCBLFleeceDomain);
+        
+        // The first batch was committed:
+        CHECK(CBLCollection_Count(col) == 2);
+    }
+    
+    SECTION("Not an Object") {
+        ImportReaderContext readerContext {"[1, 2, 3]\n"_sl, 1024};
+        CHECK(!CBLCollection_ImportJSONLines(col, importReader, &readerContext, &options, &count, &error));
+        CheckError(error, kCBLErrorInvalidParameter);
+        CHECK(CBLCollection_Count(col) == 0);
+    }
+    
+    SECTION("Missing Document ID") {
+        ImportReaderContext readerContext {"{\"id\":\"doc1\"}\n{\"name\":\"doc2\"}\n"_sl, 1024};
+        CHECK(!CBLCollection_ImportJSONLines(col, importReader, &readerContext, &options, &count, &error));
+        CheckError(error, kCBLErrorBadDocID);
+        CHECK(CBLCollection_Count(col) == 0);
+    }
+    
+    SECTION("Non-Existing File") {
+        CHECK(!CBLCollection_ImportJSONLinesFile(col, "/no/such/file.json"_sl, &options, &count, &error));
+        CheckError(error, kCBLErrorCantOpenFile);
+    }
+}
+
+#pragma mark - Enumeration:
+
+static vector<string> enumerateDocIDs(CBLCollection* col, const CBLDocumentEnumeratorOptions* options) {
+    CBLError error {};
+    CBLDocumentEnumerator* e = CBLCollection_EnumerateDocuments(col, options, &error);
+    REQUIRE(e);
+    vector<string> docIDs;
+    while (CBLDocumentEnumerator_Next(e, &error))
+        docIDs.push_back(slice(CBLDocumentEnumerator_DocumentID(e)).asString());
+    CHECK(error.code == 0);
+    CBLDocumentEnumerator_Release(e);
+    return docIDs;
+}
+
+TEST_CASE_METHOD(DocumentTest, "Enumerate Documents", "[Document][Enumerator]") {
+    createDocument(col, "doc3", "n", "3");
+    createDocument(col, "doc1", "n", "1");
+    createDocument(col, "doc5", "n", "5");
+    createDocument(col, "doc2", "n", "2");
+    createDocument(col, "doc4", "n", "4");
+    
+    CBLError error {};
+    CBLDocumentEnumeratorOptions options {};
+    options.batchSize = 2;
+    
+    SECTION("By DocID") {
+        CHECK(enumerateDocIDs(col, &options) == vector<string>{"doc1", "doc2", "doc3", "doc4", "doc5"});
+        CHECK(enumerateDocIDs(col, nullptr) == vector<string>{"doc1", "doc2", "doc3", "doc4", "doc5"});
+    }
+    
+    SECTION("By DocID Range") {
+        options.startDocID = "doc2"_sl;
+        options.endDocID = "doc4"_sl;
+        CHECK(enumerateDocIDs(col, &options) == vector<string>{"doc2", "doc3", "doc4"});
+        
+        // The skipped documents count toward the batch size, so this reads several empty batches
+        // before the first document in range:
+        options.batchSize = 1;
+        options.startDocID = "doc4"_sl;
+        options.endDocID = nullslice;
+        CHECK(enumerateDocIDs(col, &options) == vector<string>{"doc4", "doc5"});
+        
+        options.startDocID = "doc6"_sl;
+        options.endDocID = nullslice;
+        CHECK(enumerateDocIDs(col, &options).empty());
+    }
+    
+    SECTION("By Sequence") {
+        options.order = kCBLEnumerateBySequence;
+        CHECK(enumerateDocIDs(col, &options) == vector<string>{"doc3", "doc1", "doc5", "doc2", "doc4"});
+        
+        options.sinceSequence = 3;
+        CHECK(enumerateDocIDs(col, &options) == vector<string>{"doc2", "doc4"});
+    }
+    
+    SECTION("Deleted Documents") {
+        const CBLDocument* doc = CBLCollection_GetDocument(col, "doc3"_sl, &error);
+        REQUIRE(doc);
+        REQUIRE(CBLCollection_DeleteDocument(col, doc, &error));
+        CBLDocument_Release(doc);
+        
+        CHECK(enumerateDocIDs(col, &options) == vector<string>{"doc1", "doc2", "doc4", "doc5"});
+        
+        options.includeDeleted = true;
+        CBLDocumentEnumerator* e = CBLCollection_EnumerateDocuments(col, &options, &error);
+        REQUIRE(e);
+        vector<string> deleted;
+        while (CBLDocumentEnumerator_Next(e, &error)) {
+            if (CBLDocumentEnumerator_IsDeleted(e))
+                deleted.push_back(slice(CBLDocumentEnumerator_DocumentID(e)).asString());
+        }
+        CHECK(deleted == vector<string>{"doc3"});
+        CBLDocumentEnumerator_Release(e);
+    }
+    
+    SECTION("Properties and Metadata") {
+        bool metadataOnly = GENERATE(false, true);
+        options.metadataOnly = metadataOnly;
+        CBLDocumentEnumerator* e = CBLCollection_EnumerateDocuments(col, &options, &error);
+        REQUIRE(e);
+        int64_t n = 0;
+        while (CBLDocumentEnumerator_Next(e, &error)) {
+            ++n;
+            const CBLDocument* doc = CBLDocumentEnumerator_GetDocument(e, &error);
+            REQUIRE(doc);
+            CHECK(CBLDocument_ID(doc) == slice(CBLDocumentEnumerator_DocumentID(e)));
+            CHECK(CBLDocument_RevisionID(doc) == slice(CBLDocumentEnumerator_RevisionID(e)));
+            CHECK(CBLDocument_Sequence(doc) == CBLDocumentEnumerator_Sequence(e));
+            CHECK(Dict(CBLDocument_Properties(doc))["n"].asString() == slice(to_string(n)));
+            CBLDocument_Release(doc);
+            
+            FLDict props = CBLDocumentEnumerator_Properties(e);
+            if (metadataOnly) {
+                CHECK(!props);
+            } else {
+                REQUIRE(props);
+                CHECK(Dict(props)["n"].asString() == slice(to_string(n)));
+            }
+        }
+        CHECK(error.code == 0);
+        CHECK(n == 5);
+        CBLDocumentEnumerator_Release(e);
+    }
+}
+
+#pragma mark - Changes:
+
+TEST_CASE_METHOD(DocumentTest, "Get Changes Since", "[Document][Changes]") {
+    createDocument(col, "doc1", "foo", "bar");
+    createDocument(col, "doc2", "foo", "bar");
+    createDocument(col, "doc3", "foo", "bar");
+    
+    CBLError error {};
+    CBLChangeBatch* batch = CBLCollection_GetChangesSince(col, 0, 2, 0, &error);
+    REQUIRE(batch);
+    REQUIRE(CBLChangeBatch_Count(batch) == 2);
+    const CBLChangedDocument* change = CBLChangeBatch_Get(batch, 0);
+    CHECK(slice(change->docID) == "doc1"_sl);
+    CHECK(change->sequence == 1);
+    CHECK(!change->deleted);
+    CHECK(change->bodySize > 0);
+    
+    const CBLDocument* doc = CBLCollection_GetDocument(col, "doc1"_sl, &error);
+    REQUIRE(doc);
+    CHECK(slice(change->revisionID) == slice(CBLDocument_RevisionID(doc)));
+    CBLDocument_Release(doc);
+    
+    change = CBLChangeBatch_Get(batch, 1);
+    CHECK(slice(change->docID) == "doc2"_sl);
+    CHECK(change->sequence == 2);
+    uint64_t lastSequence = CBLChangeBatch_LastSequence(batch);
+    CHECK(lastSequence == 2);
+    CBLChangeBatch_Release(batch);
+    
+    // Resume from the last sequence:
+    batch = CBLCollection_GetChangesSince(col, lastSequence, 0, 0, &error);
+    REQUIRE(batch);
+    REQUIRE(CBLChangeBatch_Count(batch) == 1);
+    CHECK(slice(CBLChangeBatch_Get(batch, 0)->docID) == "doc3"_sl);
+    lastSequence = CBLChangeBatch_LastSequence(batch);
+    CHECK(lastSequence == 3);
+    CBLChangeBatch_Release(batch);
+    
+    // No more changes:
+    batch = CBLCollection_GetChangesSince(col, lastSequence, 0, 0, &error);
+    REQUIRE(batch);
+    CHECK(CBLChangeBatch_Count(batch) == 0);
+    CHECK(CBLChangeBatch_LastSequence(batch) == lastSequence);
+    CBLChangeBatch_Release(batch);
+    
+    // Update doc1 and delete doc2:
+    updateDocument(col, "doc1", "foo", "baz");
+    doc = CBLCollection_GetDocument(col, "doc2"_sl, &error);
+    REQUIRE(doc);
+    REQUIRE(CBLCollection_DeleteDocument(col, doc, &error));
+    CBLDocument_Release(doc);
+    
+    batch = CBLCollection_GetChangesSince(col, lastSequence, 0, 0, &error);
+    REQUIRE(batch);
+    REQUIRE(CBLChangeBatch_Count(batch) == 1);
+    CHECK(slice(CBLChangeBatch_Get(batch, 0)->docID) == "doc1"_sl);
+    CHECK(CBLChangeBatch_Get(batch, 0)->sequence == 4);
+    CBLChangeBatch_Release(batch);
+    
+    batch = CBLCollection_GetChangesSince(col, lastSequence, 0, kCBLChangesIncludeDeleted, &error);
+    REQUIRE(batch);
+    REQUIRE(CBLChangeBatch_Count(batch) == 2);
+    CHECK(slice(CBLChangeBatch_Get(batch, 1)->docID) == "doc2"_sl);
+    CHECK(CBLChangeBatch_Get(batch, 1)->sequence == 5);
+    CHECK(CBLChangeBatch_Get(batch, 1)->deleted);
+    CHECK(CBLChangeBatch_LastSequence(batch) == 5);
+    CBLChangeBatch_Release(batch);
+}
+
 #pragma mark - Blobs:
 
 TEST_CASE_METHOD(DocumentTest, "Set blob in document", "[Document][Blob]") {
@@ -19,6 +19,10 @@
 #include "CBLTest_Cpp.hh"
 #include "fleece/Fleece.hh"
 #include "fleece/Mutable.hh"
+#include <atomic>
+#include <future>
+#include <mutex>
+#include <stdexcept>
 #include <string>
 #include <thread>
 
@@ -147,6 +151,94 @@ TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Get Document with Empty ID", "[Document]
     REQUIRE(!doc);
 }
 
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Get Multiple Documents", "[Document]") {
+    createDocument(defaultCollection, "doc1", "foo", "bar1");
+    createDocument(defaultCollection, "doc3", "foo", "bar3");
+    
+    Doc docIDs = Doc::fromJSON("[\"doc1\", \"doc2\", \"doc3\"]");
+    auto docs = defaultCollection.getDocuments(docIDs.root().asArray());
+    REQUIRE(docs.size() == 3);
+    REQUIRE(docs[0]);
+    CHECK(docs[0].id() == "doc1");
+    CHECK(docs[0]["foo"].asString() == "bar1");
+    CHECK(!docs[1]);
+    REQUIRE(docs[2]);
+    CHECK(docs[2].id() == "doc3");
+    CHECK(docs[2]["foo"].asString() == "bar3");
+}
+
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Enumerate Documents", "[Document][Enumerator]") {
+    createDocument(defaultCollection, "doc2", "foo", "bar2");
+    createDocument(defaultCollection, "doc1", "foo", "bar1");
+    
+    auto e = defaultCollection.enumerateDocuments();
+    vector<string> docIDs;
+    while (e.next()) {
+        docIDs.push_back(string(e.docID()));
+        CHECK(e.properties()["foo"].asString().asString() == "bar" + string(e.docID()).substr(3));
+        Document doc = e.getDocument();
+        REQUIRE(doc);
+        CHECK(doc.sequence() == e.sequence());
+    }
+    CHECK(docIDs == vector<string>{"doc1", "doc2"});
+}
+
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Patch Document", "[Document]") {
+    createDocument(defaultCollection, "foo", "greeting", "Howdy!");
+    
+    defaultCollection.patchDocumentWithJSON("foo", "{\"greeting\":null,\"count\":1}");
+    Document doc = defaultCollection.getDocument("foo");
+    REQUIRE(doc);
+    CHECK(doc.propertiesAsJSON() == "{\"count\":1}");
+    
+    MutableDict patch = MutableDict::newDict();
+    patch["count"] = 2;
+    defaultCollection.patchDocument("foo", patch);
+    doc = defaultCollection.getDocument("foo");
+    CHECK(doc["count"].asInt() == 2);
+}
+
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Get Changes Since", "[Document][Changes]") {
+    createDocument(defaultCollection, "doc1", "foo", "bar");
+    createDocument(defaultCollection, "doc2", "foo", "bar");
+    
+    auto batch = defaultCollection.getChangesSince(0, 1);
+    REQUIRE(batch.count() == 1);
+    CHECK(slice(batch[0].docID) == "doc1");
+    
+    batch = defaultCollection.getChangesSince(batch.lastSequence());
+    REQUIRE(batch.count() == 1);
+    CHECK(slice(batch[0].docID) == "doc2");
+    
+    batch = defaultCollection.getChangesSince(batch.lastSequence());
+    CHECK(batch.count() == 0);
+}
+
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Read Document", "[Document]") {
+    createDocument(defaultCollection, "doc1", "foo", "bar");
+    Document doc = defaultCollection.getDocument("doc1");
+    REQUIRE(doc);
+    
+    int calls = 0;
+    bool found = defaultCollection.readDocument("doc1", [&](const CBLDocumentRevisionInfo &revision) {
+        calls++;
+        CHECK(slice(revision.docID) == "doc1");
+        CHECK(slice(revision.revisionID) == doc.revisionID());
+        CHECK(revision.sequence == doc.sequence());
+        CHECK(Dict(revision.properties)["foo"].asString() == "bar");
+    });
+    CHECK(found);
+    CHECK(calls == 1);
+    
+    CHECK(!defaultCollection.readDocument("doc2", [&](const CBLDocumentRevisionInfo&) { calls++; }));
+    CHECK(calls == 1);
+    
+    // An exception thrown by the callback is rethrown:
+    CHECK_THROWS_AS(defaultCollection.readDocument("doc1", [&](const CBLDocumentRevisionInfo&) {
+        throw std::runtime_error("oops");
+    }), std::runtime_error);
+}
+
 #pragma mark - Save Document:
 
 TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Save Empty Document", "[Document]") {
@@ -243,6 +335,117 @@ TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Save Document with FailOnConflict", "[Do
     CHECK(doc.properties().toJSONString() == "{\"greeting\":\"Howdy!\",\"name\":\"bob\"}");
 }
 
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Save Multiple Documents", "[Document]") {
+    vector<MutableDocument> docs;
+    for (int i = 1; i <= 10; i++) {
+        MutableDocument doc("doc" + to_string(i));
+        doc["number"] = i;
+        docs.push_back(doc);
+    }
+    
+    auto results = defaultCollection.saveDocuments(docs, kCBLConcurrencyControlFailOnConflict);
+    REQUIRE(results.size() == 10);
+    CHECK(defaultCollection.count() == 10);
+    for (int i = 0; i < 10; i++) {
+        CHECK(results[i]);
+        CHECK(docs[i].collection() == defaultCollection);
+        Document doc = defaultCollection.getDocument(docs[i].id());
+        REQUIRE(doc);
+        CHECK(doc["number"].asInt() == i + 1);
+        CHECK(doc.revisionID() == docs[i].revisionID());
+    }
+}
+
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Save Documents Async", "[Document][Async]") {
+    std::mutex mutex;
+    vector<string> savedIDs;
+    for (int i = 1; i <= 10; i++) {
+        MutableDocument doc("doc" + to_string(i));
+        doc["number"] = i;
+        defaultCollection.saveDocumentAsync(doc, kCBLConcurrencyControlFailOnConflict,
+                                            [&](MutableDocument saved, bool ok, CBLError) {
+            lock_guard<std::mutex> lock(mutex);
+            if (ok)
+                savedIDs.push_back(saved.id());
+        });
+    }
+    db.flushWriteQueue();
+    CHECK(savedIDs.size() == 10);
+    CHECK(defaultCollection.count() == 10);
+}
+
+#ifdef CBL_CPP_COROUTINES
+
+namespace {
+    // Minimal eagerly-started coroutine whose completion can be waited on with a future.
+    struct TestTask {
+        struct promise_type {
+            std::promise<void> done;
+            TestTask get_return_object()                {return {done.get_future()};}
+            std::suspend_never initial_suspend() noexcept {return {};}
+            std::suspend_never final_suspend() noexcept {return {};}
+            void return_void()                          {done.set_value();}
+            void unhandled_exception()                  {done.set_exception(std::current_exception());}
+        };
+        std::future<void> finished;
+    };
+}
+
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Coroutine API", "[Document][Async]") {
+    atomic<int> jobs {0};
+    Executor executor = [&](std::function<void()> job) {
+        ++jobs;
+        std::thread(std::move(job)).detach();
+    };
+    
+    // The coroutine resumes on the executor's threads, so it only records what happened;
+    // the checks are made on the test's thread.
+    Collection col = defaultCollection;
+    Database database = db;
+    bool saved1 = false, saved2 = false, savedStale = true;
+    int64_t readNumber = 0;
+    bool foundMissing = true;
+    vector<int64_t> queried;
+    auto task = [&]() -> TestTask {
+        MutableDocument doc("foo");
+        doc["number"] = 1;
+        saved1 = co_await col.saveAsync(doc, kCBLConcurrencyControlFailOnConflict, executor);
+        
+        Document saved = co_await col.getDocumentAsync("foo", executor);
+        readNumber = saved["number"].asInt();
+        
+        MutableDocument mdoc = co_await col.getMutableDocumentAsync("foo", executor);
+        mdoc["number"] = 2;
+        saved2 = co_await col.saveAsync(mdoc, kCBLConcurrencyControlFailOnConflict, executor);
+        
+        // A conflict isn't an exception:
+        MutableDocument stale("foo");
+        stale["number"] = 3;
+        savedStale = co_await col.saveAsync(stale, kCBLConcurrencyControlFailOnConflict, executor);
+        
+        Document missing = co_await col.getDocumentAsync("bar", executor);
+        foundMissing = bool(missing);
+        
+        Query query = database.createQuery(kCBLN1QLLanguage, "SELECT number FROM CBLTestCollectionCpp");
+        ResultSet results = co_await query.executeAsync(executor);
+        for (auto &result : results)
+            queried.push_back(result.valueAtIndex(0).asInt());
+    };
+    
+    auto finished = task().finished;
+    REQUIRE(finished.wait_for(chrono::seconds(10)) == future_status::ready);
+    finished.get();
+    CHECK(saved1);
+    CHECK(readNumber == 1);
+    CHECK(saved2);
+    CHECK(!savedStale);
+    CHECK(!foundMissing);
+    CHECK(queried == vector<int64_t>{2});
+    CHECK(jobs == 7);
+}
+
+#endif
+
 TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Save Document with Conflict Handler", "[Document]") {
     MutableDocument doc("foo");
     doc["greeting"] = "Howdy!";
@@ -481,6 +684,17 @@ TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Purge Doc from Different Collection", "[
     CheckError(error, kCBLErrorInvalidParameter);
 }
 
+TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Delete and Purge Multiple Documents", "[Document]") {
+    createDocument(defaultCollection, "doc1", "foo", "bar1");
+    createDocument(defaultCollection, "doc2", "foo", "bar2");
+    
+    Doc docIDs = Doc::fromJSON("[\"doc1\", \"doc2\", \"doc3\"]");
+    CHECK(defaultCollection.deleteDocuments(docIDs.root().asArray()) == std::vector<bool>{true, true, false});
+    CHECK(!defaultCollection.getDocument("doc1"));
+    CHECK(defaultCollection.purgeDocuments(docIDs.root().asArray()) == std::vector<bool>{true, true, false});
+    CHECK(defaultCollection.count() == 0);
+}
+
 #pragma mark - Document Expiry:
 
 TEST_CASE_METHOD(DocumentTest_Cpp, "C++ Document Expiration", "[Document][Expiry]") {
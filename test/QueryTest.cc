@@ -25,6 +25,8 @@
 #include <mutex>
 #include <thread>
 #include <atomic>
+#include <cerrno>
+#include <condition_variable>
 
 using namespace std;
 using namespace fleece;
@@ -170,6 +172,202 @@ TEST_CASE_METHOD(QueryTest, "Query", "[Query]") {
     CHECK(n == 3);
 }
 
+/** Collects the results of asynchronous queries. */
+struct AsyncQueryResults {
+    mutex m;
+    condition_variable cond;
+    int calls = 0;
+    int count = -1;
+    CBLError error {};
+    
+    static void completion(void *context, CBLResultSet* rs, CBLError error) {
+        auto self = (AsyncQueryResults*)context;
+        int count = rs ? countResults(rs) : -1;
+        lock_guard<mutex> lock(self->m);
+        ++self->calls;
+        self->count = count;
+        self->error = error;
+        self->cond.notify_all();
+    }
+    
+    bool wait() {
+        unique_lock<mutex> lock(m);
+        return cond.wait_for(lock, chrono::seconds(10), [&] { return calls > 0; });
+    }
+};
+
+
+TEST_CASE_METHOD(QueryTest, "Query Execute Async", "[Query][Async]") {
+    CBLError error;
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
+                                    "SELECT name FROM _ WHERE birthday like '1959-%'"_sl,
+                                    nullptr, &error);
+    REQUIRE(query);
+    
+    SECTION("Completes") {
+        AsyncQueryResults results;
+        CBLQueryTask* task = CBLQuery_ExecuteAsync(query, 0, AsyncQueryResults::completion,
+                                                   &results, &error);
+        REQUIRE(task);
+        REQUIRE(results.wait());
+        CHECK(results.count == 3);
+        CHECK(results.error.code == 0);
+        
+        // Canceling a finished task does nothing:
+        CBLQueryTask_Cancel(task);
+        CBLQueryTask_Release(task);
+        CHECK(results.calls == 1);
+    }
+    
+    SECTION("Canceled") {
+        AsyncQueryResults results;
+        CBLQueryTask* task = CBLQuery_ExecuteAsync(query, 0, AsyncQueryResults::completion,
+                                                   &results, &error);
+        REQUIRE(task);
+        CBLQueryTask_Cancel(task);
+        CBLQueryTask_Release(task);
+        REQUIRE(results.wait());
+        // The query may have finished before it was canceled:
+        if (results.count < 0) {
+            CHECK(results.error.domain == kCBLPOSIXDomain);
+            CHECK(results.error.code == ECANCELED);
+        } else {
+            CHECK(results.count == 3);
+        }
+    }
+    
+    SECTION("Many") {
+        AsyncQueryResults results[10];
+        for (auto &r : results)
+            CBLQueryTask_Release(CBLQuery_ExecuteAsync(query, 10000, AsyncQueryResults::completion,
+                                                       &r, &error));
+        for (auto &r : results) {
+            REQUIRE(r.wait());
+            CHECK(r.count == 3);
+        }
+    }
+}
+
+
+TEST_CASE_METHOD(QueryTest, "Query Result Batches", "[Query]") {
+    CBLError error;
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
+                                    "SELECT name.first, length(name.first), length(name.first) > 5, nope "
+                                    "FROM _ WHERE birthday like '1959-%' ORDER BY birthday"_sl,
+                                    nullptr, &error);
+    REQUIRE(query);
+    results = CBLQuery_Execute(query, &error);
+    REQUIRE(results);
+    
+    const CBLColumnSpec specs[5] = {
+        {0, kCBLColumnString},
+        {1, kCBLColumnInt64},
+        {1, kCBLColumnDouble},
+        {2, kCBLColumnBool},
+        {3, kCBLColumnInt64},
+    };
+    FLSlice names[2];
+    int64_t lengths[2];
+    double doubleLengths[2];
+    bool longNames[2];
+    int64_t missing[2];
+    uint8_t nameNulls = 0xFF, missingNulls = 0;
+    CBLColumnBuffer buffers[5] = {
+        {names, &nameNulls},
+        {lengths, nullptr},
+        {doubleLengths, nullptr},
+        {longNames, nullptr},
+        {missing, &missingNulls},
+    };
+    
+    REQUIRE(CBLResultSet_NextBatch(results, 2, specs, buffers, 5, &error) == 2);
+    CHECK(slice(names[0]) == "Tyesha"_sl);
+    CHECK(slice(names[1]) == "Eddie"_sl);
+    CHECK((nameNulls & 0x03) == 0);
+    CHECK(lengths[0] == 6);
+    CHECK(lengths[1] == 5);
+    CHECK(doubleLengths[0] == 6.0);
+    CHECK(longNames[0]);
+    CHECK(!longNames[1]);
+    CHECK(missing[0] == 0);
+    CHECK((missingNulls & 0x03) == 0x03);
+    
+    // The result set is positioned on the last row of the batch:
+    CHECK(FLValue_AsString(CBLResultSet_ValueAtIndex(results, 0)) == "Eddie"_sl);
+    
+    REQUIRE(CBLResultSet_NextBatch(results, 2, specs, buffers, 5, &error) == 1);
+    CHECK(slice(names[0]) == "Diedre"_sl);
+    CHECK(lengths[0] == 6);
+    CHECK(CBLResultSet_NextBatch(results, 2, specs, buffers, 5, &error) == 0);
+    
+    // Invalid column:
+    ExpectingExceptions x;
+    CBLColumnSpec badSpec = {4, kCBLColumnInt64};
+    error = {};
+    CHECK(CBLResultSet_NextBatch(results, 2, &badSpec, buffers, 1, &error) == 0);
+    CheckError(error, kCBLErrorInvalidParameter);
+}
+
+
+TEST_CASE_METHOD(QueryTest, "Query Profiling", "[Query]") {
+    CBLError error;
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
+                                    "SELECT name.first FROM _ WHERE birthday like '1959-%'"_sl,
+                                    nullptr, &error);
+    REQUIRE(query);
+    
+    // Without profiling, only the compile time is known:
+    results = CBLQuery_Execute(query, &error);
+    REQUIRE(results);
+    CHECK(countResults(results) == 3);
+    CBLQueryStats stats = CBLResultSet_Stats(results);
+    CHECK(stats.compileNS > 0);
+    CHECK(stats.executeNS == 0);
+    CHECK(stats.rowsReturned == 0);
+    CHECK(stats.indexesUsed == nullptr);
+    CBLResultSet_Release(results);
+    
+    CBLQuery_SetProfilingEnabled(query, true);
+    results = CBLQuery_Execute(query, &error);
+    REQUIRE(results);
+    REQUIRE(CBLResultSet_Next(results));
+    CHECK(CBLResultSet_ValueAtIndex(results, 0));
+    stats = CBLResultSet_Stats(results);
+    CHECK(stats.executeNS > 0);
+    CHECK(stats.firstRowNS >= stats.executeNS);
+    CHECK(stats.enumerationNS == 0);
+    CHECK(stats.rowsReturned == 1);
+    CHECK(stats.valuesRead == 1);
+    while (CBLResultSet_Next(results)) { }
+    stats = CBLResultSet_Stats(results);
+    CHECK(stats.enumerationNS >= stats.firstRowNS);
+    CHECK(stats.rowsReturned == 3);
+    CHECK(stats.fullScan);
+    REQUIRE(stats.indexesUsed);
+    CHECK(FLArray_Count(stats.indexesUsed) == 0);
+    CBLResultSet_Release(results);
+    CBLQuery_Release(query);
+    
+    // A query that uses an index:
+    CBLValueIndexConfiguration index = {};
+    index.expressionLanguage = kCBLN1QLLanguage;
+    index.expressions = "gender"_sl;
+    REQUIRE(CBLCollection_CreateValueIndex(defaultCollection, "genders"_sl, index, &error));
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
+                                    "SELECT name.first FROM _ WHERE gender = 'female'"_sl,
+                                    nullptr, &error);
+    REQUIRE(query);
+    CBLQuery_SetProfilingEnabled(query, true);
+    results = CBLQuery_Execute(query, &error);
+    REQUIRE(results);
+    CHECK(countResults(results) > 0);
+    stats = CBLResultSet_Stats(results);
+    CHECK(!stats.fullScan);
+    REQUIRE(FLArray_Count(stats.indexesUsed) == 1);
+    CHECK(FLValue_AsString(FLArray_Get(stats.indexesUsed, 0)) == "genders"_sl);
+}
+
+
 TEST_CASE_METHOD(QueryTest, "Unicode Query", "[Query]"){
     CBLError error;
     int errPos;
@@ -326,6 +524,204 @@ TEST_CASE_METHOD(QueryTest, "Query Parameters", "[Query]") {
 }
 
 
+TEST_CASE_METHOD(QueryTest, "Query Execute Batch", "[Query]") {
+    CBLError error;
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
+                                    "SELECT count(*) AS n FROM _ WHERE contact.address.zip BETWEEN $zip0 AND $zip1"_sl,
+                                    nullptr, &error);
+    REQUIRE(query);
+    {
+        auto params = MutableDict::newDict();
+        params["zip0"] = "00000";
+        params["zip1"] = "99999";
+        CBLQuery_SetParameters(query, params);
+    }
+    
+    auto paramSets = MutableArray::newArray();
+    for (auto zips : {"30000-39999", "00000-00001", "30000-39999"}) {
+        auto params = MutableDict::newDict();
+        params["zip0"] = slice(zips, 5);
+        params["zip1"] = slice(zips + 6, 5);
+        paramSets.append(Value(params));
+    }
+    
+    struct BatchResults {
+        vector<pair<unsigned, int64_t>> counts;
+        unsigned stopAfter = 99;
+    } batch;
+    auto callback = [](void *context, unsigned index, CBLResultSet *rs) -> bool {
+        auto batch = (BatchResults*)context;
+        CHECK(CBLResultSet_Next(rs));
+        batch->counts.emplace_back(index, FLValue_AsInt(CBLResultSet_ValueAtIndex(rs, 0)));
+        return batch->counts.size() < batch->stopAfter;
+    };
+    
+    SECTION("All") {
+        REQUIRE(CBLQuery_ExecuteBatch(query, paramSets, callback, &batch, &error));
+        CHECK(batch.counts == (vector<pair<unsigned, int64_t>>{{0, 7}, {1, 0}, {2, 7}}));
+    }
+    
+    SECTION("Stop Early") {
+        batch.stopAfter = 2;
+        REQUIRE(CBLQuery_ExecuteBatch(query, paramSets, callback, &batch, &error));
+        CHECK(batch.counts == (vector<pair<unsigned, int64_t>>{{0, 7}, {1, 0}}));
+    }
+    
+    SECTION("Invalid Parameter Set") {
+        paramSets.append("zip"_sl);
+        ExpectingExceptions x;
+        CHECK(!CBLQuery_ExecuteBatch(query, paramSets, callback, &batch, &error));
+        CheckError(error, kCBLErrorInvalidParameter);
+        CHECK(batch.counts.empty());
+    }
+    
+    // The query's own parameters are unchanged:
+    FLDict params = CBLQuery_Parameters(query);
+    CHECK(FLValue_AsString(FLDict_Get(params, "zip0"_sl)) == "00000"_sl);
+    results = CBLQuery_Execute(query, &error);
+    REQUIRE(results);
+    REQUIRE(CBLResultSet_Next(results));
+    CHECK(FLValue_AsInt(CBLResultSet_ValueAtIndex(results, 0)) > 7);
+}
+
+
+TEST_CASE_METHOD(QueryTest, "Compiled Query Cache", "[Query]") {
+    CBLError error;
+    slice str = "SELECT count(*) AS n FROM _ WHERE contact.address.zip BETWEEN $zip0 AND $zip1"_sl;
+    
+    auto countZips = [&](CBLQuery *q, const char *zip0, const char *zip1) {
+        auto params = MutableDict::newDict();
+        params["zip0"] = zip0;
+        params["zip1"] = zip1;
+        CBLQuery_SetParameters(q, params);
+        CBLResultSet *rs = CBLQuery_Execute(q, &error);
+        REQUIRE(rs);
+        REQUIRE(CBLResultSet_Next(rs));
+        int64_t n = FLValue_AsInt(CBLResultSet_ValueAtIndex(rs, 0));
+        CBLResultSet_Release(rs);
+        return n;
+    };
+    
+    // Disabled by default:
+    CHECK(CBLDatabase_GetQueryCacheStats(db).capacity == 0);
+    REQUIRE(CBLDatabase_SetQueryCacheCapacity(db, 2, &error));
+    
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage, str, nullptr, &error);
+    REQUIRE(query);
+    CBLQuery* query2 = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage, str, nullptr, &error);
+    REQUIRE(query2);
+    CHECK(query2 != query);
+    
+    CBLQueryCacheStats stats = CBLDatabase_GetQueryCacheStats(db);
+    CHECK(stats.hits == 1);
+    CHECK(stats.misses == 1);
+    CHECK(stats.count == 1);
+    CHECK(stats.capacity == 2);
+    
+    // Queries sharing a compiled query still have their own parameters:
+    CHECK(countZips(query, "30000", "39999") == 7);
+    CHECK(countZips(query2, "00000", "99999") == 100);
+    CBLResultSet* rs = CBLQuery_Execute(query, &error);
+    REQUIRE(rs);
+    REQUIRE(CBLResultSet_Next(rs));
+    CHECK(FLValue_AsInt(CBLResultSet_ValueAtIndex(rs, 0)) == 7);
+    CBLResultSet_Release(rs);
+    CBLQuery_Release(query2);
+    
+    SECTION("Eviction") {
+        for (int i = 0; i < 2; ++i) {
+            string other = "SELECT name.first FROM _ LIMIT " + to_string(i + 1);
+            CBLQuery_Release(CBLDatabase_CreateQuery(db, kCBLN1QLLanguage, slice(other), nullptr, &error));
+        }
+        stats = CBLDatabase_GetQueryCacheStats(db);
+        CHECK(stats.count == 2);
+        CHECK(stats.evictions == 1);
+        CHECK(countZips(query, "30000", "39999") == 7);
+    }
+    
+    SECTION("Creating an index clears the cache") {
+        CBLValueIndexConfiguration config = {};
+        config.expressionLanguage = kCBLJSONLanguage;
+        config.expressions = R"([".contact.address.zip"])"_sl;
+        REQUIRE(CBLCollection_CreateValueIndex(defaultCollection, "zips"_sl, config, &error));
+        CHECK(CBLDatabase_GetQueryCacheStats(db).count == 0);
+    }
+    
+    SECTION("Disable") {
+        REQUIRE(CBLDatabase_SetQueryCacheCapacity(db, 0, &error));
+        stats = CBLDatabase_GetQueryCacheStats(db);
+        CHECK(stats.count == 0);
+        CHECK(stats.capacity == 0);
+        CHECK(countZips(query, "30000", "39999") == 7);
+    }
+}
+
+
+TEST_CASE_METHOD(QueryTest, "Keyset Pagination", "[Query]") {
+    CBLError error;
+    bool descending = false;
+    SECTION("Ascending") { }
+    SECTION("Descending") {descending = true;}
+    
+    CBLValueIndexConfiguration index = {};
+    index.expressionLanguage = kCBLN1QLLanguage;
+    index.expressions = "gender"_sl;
+    REQUIRE(CBLCollection_CreateValueIndex(defaultCollection, "genders"_sl, index, &error));
+    
+    // The expected order, from a single query:
+    string str = string("SELECT meta().id FROM _ WHERE gender IS VALUED ORDER BY gender")
+               + (descending ? " DESC" : "") + ", meta().id" + (descending ? " DESC" : "");
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage, slice(str), nullptr, &error);
+    REQUIRE(query);
+    vector<string> expected;
+    results = CBLQuery_Execute(query, &error);
+    REQUIRE(results);
+    while (CBLResultSet_Next(results))
+        expected.emplace_back(slice(FLValue_AsString(CBLResultSet_ValueAtIndex(results, 0))));
+    REQUIRE(expected.size() == 100);
+    
+    // Page through the same results; the keys (genders) have many duplicates, so pages begin in
+    // the middle of a run of equal keys:
+    CBLKeysetQueryConfiguration config = {};
+    config.collection = "_"_sl;
+    config.select = "name.first"_sl;
+    config.orderBy = "gender"_sl;
+    config.descending = descending;
+    config.pageSize = 30;
+    
+    vector<string> paged;
+    alloc_slice token;
+    unsigned pages = 0;
+    do {
+        CBLQuery* pageQuery = CBLDatabase_CreateKeysetQuery(db, &config, token, &error);
+        REQUIRE(pageQuery);
+        CHECK(CBLQuery_ColumnCount(pageQuery) == 3);
+        if (token) {
+            alloc_slice explanation(CBLQuery_Explain(pageQuery));
+            CHECK(explanation.find("genders"_sl));
+        }
+        CBLResultSet* rs = CBLQuery_Execute(pageQuery, &error);
+        REQUIRE(rs);
+        token = nullslice;
+        while (CBLResultSet_Next(rs)) {
+            paged.emplace_back(slice(FLValue_AsString(CBLResultSet_ValueAtIndex(rs, 2))));
+            token = alloc_slice(CBLResultSet_ContinuationToken(rs, &error));
+            REQUIRE(token);
+        }
+        CBLResultSet_Release(rs);
+        CBLQuery_Release(pageQuery);
+        ++pages;
+    } while (token);
+    CHECK(pages == 5);      // The fourth page has 10 results, and the fifth none
+    CHECK(paged == expected);
+    
+    // Invalid token:
+    ExpectingExceptions x;
+    CHECK(!CBLDatabase_CreateKeysetQuery(db, &config, "[1]"_sl, &error));
+    CheckError(error, kCBLErrorInvalidParameter);
+}
+
+
 TEST_CASE_METHOD(QueryTest, "Create and Delete Value Index", "[Query]") {
     CBLError error;
     int errPos;
@@ -501,6 +897,111 @@ TEST_CASE_METHOD(QueryTest, "Query Result As Array", "[Query]") {
 }
 
 
+TEST_CASE_METHOD(QueryTest, "Query Result Column Values", "[Query]") {
+    CBLError error;
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
+                                    "SELECT name.first AS first, foo, name.last AS last FROM _ "
+                                    "WHERE birthday like '1959-%' ORDER BY birthday"_sl,
+                                    nullptr, &error);
+    REQUIRE(query);
+    CHECK(CBLQuery_ColumnIndex(query, "first"_sl) == 0);
+    CHECK(CBLQuery_ColumnIndex(query, "last"_sl) == 2);
+    CHECK(CBLQuery_ColumnIndex(query, "nope"_sl) == -1);
+
+    static const slice kExpectedFirst[3] = {"Tyesha",  "Eddie",     "Diedre"};
+    static const slice kExpectedLast [3] = {"Loehrer", "Colangelo", "Clinton"};
+
+    int n = 0;
+    results = CBLQuery_Execute(query, &error);
+    REQUIRE(results);
+    while (CBLResultSet_Next(results)) {
+        REQUIRE(n < 3);
+        FLValue values[4] = {};
+        REQUIRE(CBLResultSet_GetColumnValues(results, values, 4) == 3);
+        CHECK(FLValue_AsString(values[0]) == kExpectedFirst[n]);
+        CHECK(values[1] == nullptr);
+        CHECK(FLValue_AsString(values[2]) == kExpectedLast[n]);
+        REQUIRE(CBLResultSet_GetColumnValues(results, values, 1) == 1);
+        CHECK(FLValue_AsString(values[0]) == kExpectedFirst[n]);
+        ++n;
+    }
+    CHECK(n == 3);
+}
+
+
+TEST_CASE_METHOD(QueryTest, "Query Result Write JSON", "[Query]") {
+    CBLError error;
+    query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
+                                    "SELECT name.first AS first, foo, name.last AS last FROM _ "
+                                    "WHERE birthday like '1959-%' ORDER BY birthday"_sl,
+                                    nullptr, &error);
+    REQUIRE(query);
+    results = CBLQuery_Execute(query, &error);
+    REQUIRE(results);
+
+    struct JSONOutput {
+        string json;
+        int chunks = 0;
+        int maxChunks = 99;
+    } output;
+    auto callback = [](void *context, FLSlice chunk) -> bool {
+        auto output = (JSONOutput*)context;
+        output->json += string(slice(chunk));
+        return ++output->chunks < output->maxChunks;
+    };
+
+    const unsigned firstColumn[1] = {0};
+    CBLResultJSONOptions options = {};
+
+    SECTION("Default") {
+        REQUIRE(CBLResultSet_WriteJSON(results, nullptr, callback, &output, &error));
+        CHECK(output.json == R"([{"first":"Tyesha","last":"Loehrer"},{"first":"Eddie","last":"Colangelo"},)"
+                             R"({"first":"Diedre","last":"Clinton"}])");
+        CHECK(output.chunks == 1);
+        CHECK(!CBLResultSet_Next(results));
+    }
+
+    SECTION("Lines") {
+        options.format = kCBLResultJSONLines;
+        options.columns = firstColumn;
+        options.columnCount = 1;
+        REQUIRE(CBLResultSet_WriteJSON(results, &options, callback, &output, &error));
+        CHECK(output.json == "{\"first\":\"Tyesha\"}\n{\"first\":\"Eddie\"}\n{\"first\":\"Diedre\"}\n");
+    }
+
+    SECTION("Pretty") {
+        options.pretty = true;
+        options.columns = firstColumn;
+        options.columnCount = 1;
+        options.chunkSize = 1;
+        REQUIRE(CBLResultSet_WriteJSON(results, &options, callback, &output, &error));
+        CHECK(output.json == "[\n  {\n    \"first\": \"Tyesha\"\n  },\n  {\n    \"first\": \"Eddie\"\n  },"
+                             "\n  {\n    \"first\": \"Diedre\"\n  }\n]");
+        CHECK(output.chunks == 4);
+    }
+
+    SECTION("Stopped") {
+        options.chunkSize = 1;
+        output.maxChunks = 1;
+        ExpectingExceptions x;
+        CHECK(!CBLResultSet_WriteJSON(results, &options, callback, &output, &error));
+        CHECK(error.domain == kCBLPOSIXDomain);
+        CHECK(error.code == ECANCELED);
+        CHECK(output.chunks == 1);
+    }
+
+    SECTION("Invalid Column") {
+        const unsigned badColumn[1] = {3};
+        options.columns = badColumn;
+        options.columnCount = 1;
+        ExpectingExceptions x;
+        CHECK(!CBLResultSet_WriteJSON(results, &options, callback, &output, &error));
+        CheckError(error, kCBLErrorInvalidParameter);
+        CHECK(output.chunks == 0);
+    }
+}
+
+
 TEST_CASE_METHOD(QueryTest, "Query Listener", "[Query][LiveQuery]") {
     CBLError error;
     query = CBLDatabase_CreateQuery(db, kCBLN1QLLanguage,
@@ -140,6 +140,29 @@ TEST_CASE_METHOD(QueryTest_Cpp, "Empty Query Listener C++", "[Query][QueryCpp]")
     listenerToken.remove(); // Noops
 }
 
+TEST_CASE_METHOD(QueryTest_Cpp, "Query Listener C++ on Single-Threaded Database", "[Query][QueryCpp]") {
+    auto config = CBLTest::databaseConfig();
+    config.singleThreaded = true;
+    Database::deleteDatabase("singlethreadeddb", config.directory);
+    Database stDB("singlethreadeddb", config);
+    REQUIRE(stDB);
+    
+    {
+        Query query(stDB, kCBLN1QLLanguage, "SELECT name FROM _");
+        CBLError error {};
+        try {
+            ExpectingExceptions x;
+            auto listenerToken = query.addChangeListener([](Query::Change) { });
+        } catch (CBLError e) {
+            error = e;
+        }
+        CHECK(error.domain == kCBLDomain);
+        CHECK(error.code == kCBLErrorUnsupported);
+    }
+    
+    stDB.close();
+}
+
 TEST_CASE_METHOD(QueryTest_Cpp, "Query Listener C++ Move Operation", "[Query][QueryCpp]") {
     Query query(db, kCBLN1QLLanguage, "SELECT name FROM _ WHERE birthday like '1959-%' ORDER BY birthday");
     